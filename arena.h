@@ -0,0 +1,46 @@
+// PMD32-Mega2560 (c) 2025 J. Bogin, https://boginjr.com
+// Based on PMD32-SD (c) 2012 R. Borik, https://pmd85.borik.net/
+// Static arena for transient buffers
+
+#pragma once
+#include "config.h"
+
+// bytes reserved at compile time, the heap is not used after boot;
+// 512 of the Mega's 8K SRAM for good, but counted in the build's RAM figure, unlike a sector buffer
+// on the stack of the deepest UI and SdFat call chains, and shared by the image fill, catalog and sorted views
+#define ARENA_SIZE 512
+
+class Arena
+{
+public:
+
+  // LIFO use: take mark(), alloc(), then release(mark) when done
+  // returns NULL if the request does not fit
+  template <typename T>
+  static T* alloc(WORD count)
+  {
+    const WORD size = count * sizeof(T);
+    if (size > (ARENA_SIZE - m_used))
+    {
+      return NULL;
+    }
+    
+    T* result = (T*)&m_buffer[m_used];
+    m_used += size;
+    if (m_used > m_highWater)
+    {
+      m_highWater = m_used;
+    }
+    
+    return result;
+  }
+  
+  static WORD mark() { return m_used; }
+  static void release(WORD mark) { if (mark < m_used) m_used = mark; }
+  static WORD highWater() { return m_highWater; }
+  
+private:
+  inline static BYTE m_buffer[ARENA_SIZE];
+  inline static WORD m_used = 0;
+  inline static WORD m_highWater = 0;
+};
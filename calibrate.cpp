@@ -5,11 +5,16 @@
 
 #include "config.h"
 
-#ifdef TOUCH_SCREEN_CALIBRATION
+// display and panel of the calibration running; the rest is on the stack, as it runs at boot only
+static MCUFRIEND_kbv* tft;
+static Touch* ts;
 
-MCUFRIEND_kbv tft;
-Touch ts;
-TSPoint tp;
+// raw readings of the crosshairs and where they were drawn
+struct CalPoints
+{
+    uint32_t rx[8], ry[8];
+    int sx[8], sy[8];
+};
 
 #define WHITE 0xFFFF
 #define RED   0xF800
@@ -18,14 +23,23 @@ TSPoint tp;
 
 #define TITLE "Touch screen calibration"
 
-bool ISPRESSED(void)
+#define WAIT_MS    20000 // panel not answering for as long: calibration given up, the stored or default matrix stays
+#define BOUNCE_MAX 1000  // readings flipping for as long: not pressed (panel not connected)
+
+const int dispx = DISP_WIDTH;
+const int dispy = DISP_HEIGHT;
+const int text_y_center = DISP_HEIGHT / 2;
+
+static bool ISPRESSED(void)
 {
     int count = 0;
-    bool state, oldstate;
+    int tries = 0;
+    bool state, oldstate = false;
     while (count < 10)
     {
-        tp = ts.getPointRaw();
-        state = tp.z > 20;
+        if (++tries > BOUNCE_MAX)
+            return false;
+        state = ts->getPointRaw().z > 20;
         if (state == oldstate) count++;
         else count = 0;
         oldstate = state;
@@ -34,93 +48,105 @@ bool ISPRESSED(void)
     return oldstate;
 }
 
-uint32_t cx, cy, cz;
-uint32_t rx[8], ry[8];
-int32_t clx, crx, cty, cby;
-float px, py;
-int dispx, dispy, text_y_center, swapxy;
-uint32_t calx, caly, cals;
+static bool waitPressed(bool pressed)
+{
+    // false if the panel did not get there within WAIT_MS
+    uint32_t start = millis();
+    while (ISPRESSED() != pressed) {
+        if (millis() - start > WAIT_MS)
+            return false;
+    }
+    return true;
+}
 
-void centerprint(const char *s, int y)
+static void centerprint(const char *s, int y)
 {
     int len = strlen(s) * 8;
-    tft.fillRect((dispx - len) / 2, y-10, len, 12, RED);
-    tft.setCursor((dispx - len) / 2, y);
-    tft.print(s);
+    tft->fillRect((dispx - len) / 2, y-10, len, 12, RED);
+    tft->setCursor((dispx - len) / 2, y);
+    tft->print(s);
 }
 
-void centertitle(const char *s)
+static void centertitle(const char *s)
 {
-    tft.fillScreen(BLACK);
-    tft.fillRect(0, 0, dispx, 24, RED);
-    tft.fillRect(0, 24, dispx, 1, WHITE);
+    tft->fillScreen(BLACK);
+    tft->fillRect(0, 0, dispx, 24, RED);
+    tft->fillRect(0, 24, dispx, 1, WHITE);
     centerprint(s, 16);
-    tft.setCursor(0, 30);
-    tft.setTextColor(WHITE, BLACK);
+    tft->setCursor(0, 30);
+    tft->setTextColor(WHITE, BLACK);
 }
 
-void startup()
+static bool startup()
 {
     centertitle(TITLE);
 
-    tft.println(F("\nUse a stylus or something similar"));
-    tft.println(F("to touch, as close to the center,"));
-    tft.println(F("each WHITE crosshair.\n"));    
-    tft.println(F("Keep holding until it turns RED !"));
-    tft.println(F("Repeat for all crosshairs.\n"));
-    tft.println(F("Touch screen to continue"));
+    tft->println(F("\nUse a stylus or something similar"));
+    tft->println(F("to touch, as close to the center,"));
+    tft->println(F("each WHITE crosshair.\n"));    
+    tft->println(F("Keep holding until it turns RED !"));
+    tft->println(F("Repeat for all crosshairs.\n"));
+    tft->println(F("Touch screen to continue"));
 
-    while (ISPRESSED() == false) {}
-    while (ISPRESSED() == true) {}
+    return waitPressed(false) && // held since powering up
+           waitPressed(true) &&
+           waitPressed(false);
 }
 
-void fail()
+static bool fail(bool missed = false)
 {
     centertitle("Touch Calibration FAILED");
 
-    tft.println(F("\nUnable to read the position of"));
-    tft.println(F("the press; this is a HW issue.\n"));
+    if (missed) {
+        tft->println(F("\nThe presses do not line up; touch"));
+        tft->println(F("each crosshair at its center.\n"));
+    } else {
+        tft->println(F("\nUnable to read the position of"));
+        tft->println(F("the press; this is a HW issue.\n"));
 #ifndef TOUCH_SCREEN_ACTIVE
-    tft.println(F("Check resistance between pins:"));
-    tft.println(F("XP <-> XM; YP <-> YM"));    
-    tft.println(F("should be about 300 ohms."));
+        tft->println(F("Check resistance between pins:"));
+        tft->println(F("XP <-> XM; YP <-> YM"));
+        tft->println(F("should be about 300 ohms.\n"));
 #endif
+    }
+    tft->println(F("Touch screen to continue"));
 
-    while (true) {};
+    if (waitPressed(true))
+        waitPressed(false);
+    return false;
 }
 
-void drawCrossHair(int x, int y, uint16_t color)
+static void drawCrossHair(int x, int y, uint16_t color)
 {
-    tft.drawRect(x - 10, y - 10, 20, 20, color);
-    tft.drawLine(x - 5, y, x + 5, y, color);
-    tft.drawLine(x, y - 5, x, y + 5, color);
+    tft->drawRect(x - 10, y - 10, 20, 20, color);
+    tft->drawLine(x - 5, y, x + 5, y, color);
+    tft->drawLine(x, y - 5, x, y + 5, color);
 }
 
-void readCoordinates()
+static bool readCoordinates(uint32_t& cx, uint32_t& cy)
 {
     int iter = 5000;
     int failcount = 0;
     int cnt = 0;
     uint32_t tx = 0;
     uint32_t ty = 0;
-    uint32_t tz = 0;
     bool OK = false;
 
     while (OK == false)
     {
         centerprint("*  PRESS  *", text_y_center);
-        while (ISPRESSED() == false) {}
+        if (!waitPressed(true))
+            return false;
         centerprint("*  HOLD!  *", text_y_center);
         cnt = 0;
         iter = 400;
         do
         {
-            tp = ts.getPointRaw();
+            TSPoint tp = ts->getPointRaw();
             if (tp.z > 200)  //.kbv
             {
                 tx += tp.x;
                 ty += tp.y;
-                tz += tp.z;
                 cnt++;
             }
             else
@@ -134,38 +160,145 @@ void readCoordinates()
         {
             tx = 0;
             ty = 0;
-            tz = 0;
             cnt = 0;
         }
         if (failcount >= 10000)
-            fail();
+            return false;
     }
 
     cx = tx / iter;
     cy = ty / iter;
-    cz = tz / iter;
+    return true;
 }
 
-void calibrate(int x, int y, int i)
+static bool calibrate(int x, int y, int i, CalPoints& points)
 {
     drawCrossHair(x, y, WHITE);
-    readCoordinates();
+    if (!readCoordinates(points.rx[i], points.ry[i]))
+        return false;
     centerprint("* RELEASE *", text_y_center);
     drawCrossHair(x, y, RED);
-    rx[i] = cx;
-    ry[i] = cy;
-    while (ISPRESSED() == true) {}
+    points.sx[i] = x;
+    points.sy[i] = y;
+    return waitPressed(false);
+}
+
+static bool fit(const CalPoints& points, int32_t* matrix)
+{
+    const uint32_t* rx = points.rx;
+    const uint32_t* ry = points.ry;
+    const int* sx = points.sx;
+    const int* sy = points.sy;
+
+    // least squares affine fit of the 8 crosshairs, about their means to keep the float sums small
+    float mu = 0, mv = 0, mx = 0, my = 0;
+    for (int i = 0; i < 8; i++) {
+        mu += rx[i]; mv += ry[i];
+        mx += sx[i]; my += sy[i];
+    }
+    mu /= 8; mv /= 8; mx /= 8; my /= 8;
+
+    float uu = 0, uv = 0, vv = 0, ux = 0, vx = 0, uy = 0, vy = 0;
+    for (int i = 0; i < 8; i++) {
+        float u = rx[i] - mu, v = ry[i] - mv;
+        float x = sx[i] - mx, y = sy[i] - my;
+        uu += u * u; uv += u * v; vv += v * v;
+        ux += u * x; vx += v * x;
+        uy += u * y; vy += v * y;
+    }
+
+    float det = uu * vv - uv * uv;
+    if (det < 1)
+        return false; // the panel did not move between crosshairs
+
+    float m[6];
+    m[0] = (ux * vv - vx * uv) / det;
+    m[1] = (vx * uu - ux * uv) / det;
+    m[2] = mx - m[0] * mu - m[1] * mv;
+    m[3] = (uy * vv - vy * uv) / det;
+    m[4] = (vy * uu - uy * uv) / det;
+    m[5] = my - m[3] * mu - m[4] * mv;
+
+    // a crosshair missed by far: refused rather than stored
+    for (int i = 0; i < 8; i++) {
+        float ex = m[0] * rx[i] + m[1] * ry[i] + m[2] - sx[i];
+        float ey = m[3] * rx[i] + m[4] * ry[i] + m[5] - sy[i];
+        if (fabs(ex) > TOUCH_CAL_ERROR || fabs(ey) > TOUCH_CAL_ERROR)
+            return false;
+    }
+
+    for (int i = 0; i < 6; i++)
+        matrix[i] = lround(m[i] * 65536);
+    return true;
+}
+
+bool touchCalibrationWanted(Touch& touch)
+{
+    // a single sample first, the debounced check only if it is touched
+    ts = &touch;
+    return (ts->getPointRaw().z > 0) && ISPRESSED();
+}
+
+static bool touchCalibratePoints(MCUFRIEND_kbv& display, Touch& touch, CalPoints& points)
+{
+    // false: failed or given up, nothing stored
+    tft = &display;
+    ts = &touch;
+    tft->setFont(&Progmem::m_vgaFont);
+
+    if (!startup())
+        return false;
+
+    int x, y, cnt, idx = 0;
+    tft->fillScreen(BLACK);
+    for (x = 10, cnt = 0; x < dispx; x += (dispx - 20) / 2) {
+        for (y = 10; y < dispy; y += (dispy - 20) / 2) {
+            if (++cnt != 5) drawCrossHair(x, y, BLUE);
+        }
+    }
+    centerprint("***********", text_y_center - 12);
+    centerprint("***********", text_y_center + 12);
+    for (x = 10, cnt = 0; x < dispx; x += (dispx - 20) / 2) {
+        for (y = 10; y < dispy; y += (dispy - 20) / 2) {
+            if (++cnt != 5 && !calibrate(x, y, idx++, points)) return fail();
+        }
+    }
+
+    // stored as seen by setRotation(1), a flipped display folds its rotation in when loading
+    int32_t matrix[6];
+    if (!fit(points, matrix)) return fail(true);
+    if (tft->getRotation() == 3)
+        Touch::flipCalibration(matrix);
+    ts->storeCalibration(matrix);
+    return true;
 }
 
-void report()
+bool touchCalibrate(MCUFRIEND_kbv& display, Touch& touch)
+{
+    CalPoints points;
+    return touchCalibratePoints(display, touch, points);
+}
+
+#ifdef TOUCH_SCREEN_CALIBRATION
+
+static MCUFRIEND_kbv display;
+static Touch touch;
+
+static int32_t clx, crx, cty, cby;
+static float px, py;
+static int swapxy;
+static uint32_t calx, caly, cals;
+
+static void report()
 {
     uint16_t CAL_X1, CAL_Y1, CAL_X2, CAL_Y2;
     char buf[60];
     centertitle(TITLE);
 
-    tft.println(F("\nCalibration done!\n"));
-    tft.println(F("Open \"config.h\", find these defines"));
-    tft.println(F("and set them to the following values:\n"));   
+    tft->println(F("\nCalibration done, saved to EEPROM."));
+    tft->println(F("To build it in instead, open"));
+    tft->println(F("\"config.h\", find these defines"));
+    tft->println(F("and set them to the following values:\n"));   
     
     CAL_X1  = (calx >> 14) & 0x3FFF;
     CAL_Y1  = (caly >> 14) & 0x3FFF;    
@@ -173,13 +306,13 @@ void report()
     CAL_Y2  = (caly >>  0) & 0x3FFF;    
     
     sprintf(buf, "#define TOUCH_CAL_X1 %d", CAL_X1);
-    tft.println(buf);
+    tft->println(buf);
     sprintf(buf, "#define TOUCH_CAL_Y1 %d", CAL_Y1);
-    tft.println(buf);
+    tft->println(buf);
     sprintf(buf, "#define TOUCH_CAL_X2 %d", CAL_X2);
-    tft.println(buf);
+    tft->println(buf);
     sprintf(buf, "#define TOUCH_CAL_Y2 %d", CAL_Y2);
-    tft.println(buf);
+    tft->println(buf);
 }
 
 void setup()
@@ -187,34 +320,19 @@ void setup()
 #ifdef USE_MEGA_16BIT_SHIELD
     uint16_t ID = DISP_ID_16BIT;
 #else
-    uint16_t ID = tft.readID();
+    uint16_t ID = display.readID();
 #endif
-    tft.begin(ID);
-    tft.setRotation(1);
-    tft.setFont(&Progmem::m_vgaFont);
-    dispx = DISP_WIDTH;
-    dispy = DISP_HEIGHT;
-    text_y_center = (dispy / 2);
+    display.begin(ID);
+    display.setRotation(1);
 }
 
 void loop()
 {
-    startup();
-
-    int x, y, cnt, idx = 0;
-    tft.fillScreen(BLACK);
-    for (x = 10, cnt = 0; x < dispx; x += (dispx - 20) / 2) {
-        for (y = 10; y < dispy; y += (dispy - 20) / 2) {
-            if (++cnt != 5) drawCrossHair(x, y, BLUE);
-        }
-    }
-    centerprint("***********", text_y_center - 12);
-    centerprint("***********", text_y_center + 12);
-    for (x = 10, cnt = 0; x < dispx; x += (dispx - 20) / 2) {
-        for (y = 10; y < dispy; y += (dispy - 20) / 2) {
-            if (++cnt != 5) calibrate(x, y, idx++);
-        }
-    }
+    CalPoints points;
+    if (!touchCalibratePoints(display, touch, points))
+        return;            // failed, again
+    const uint32_t* rx = points.rx;
+    const uint32_t* ry = points.ry;
 
     cals = (long(dispx - 1) << 12) + (dispy - 1);
     swapxy = rx[2] - rx[0];
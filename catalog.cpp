@@ -0,0 +1,722 @@
+// PMD32-Mega2560 (c) 2025 J. Bogin, https://boginjr.com
+// Based on PMD32-SD (c) 2012 R. Borik, https://pmd85.borik.net/
+// Card-wide image catalog
+
+#include "config.h"
+
+#ifndef TOUCH_SCREEN_CALIBRATION
+
+// catalog file, one per card:
+// +0, 64:                header
+// +64, 2*MAX_IMAGES:     index area 0, record numbers in order of name (case-insensitive), then of locator
+// +64+2*MAX_IMAGES, ..:  index area 1, the other half of the sort; the header tells which one is in use
+// +64+4*MAX_IMAGES, ..:  records in order found, CatalogRecord each
+//
+// built once by walking all directories in the background (catProcess), only appending records,
+// then sorted once, a few entries per pass, by a bottom-up merge sort from one index area into the other;
+// the last pass leaves out duplicates. images created or mounted afterwards are queued (catAddImage)
+// and inserted by catProcess, records whose image is gone are dropped as they are found (catResolve).
+// a prefix search is two binary searches over the index
+
+#define CATALOG_MAGIC   0x43323350 // "P32C"
+#define CATALOG_VERSION 2
+#define CATALOG_INDEX   64L
+#define CATALOG_RECORDS (CATALOG_INDEX + (CATALOG_MAX_IMAGES * 4L))
+#define CATALOG_NEW     0xFFFF     // record not stored yet
+#define CATALOG_STEP    8          // sorted entries per pass of the main loop
+#define CATALOG_QUEUE   4          // images mounted or created, waiting to be inserted
+
+struct CatalogHeader
+{
+  DWORD magic;
+  BYTE version;
+  BYTE recordSize;
+  WORD maxImages;
+  WORD count;               // index entries
+  BYTE complete;            // 1: whole card walked and sorted
+  BYTE area;                // index area in use
+  WORD records;             // stored, incl. those left out of the index
+};
+
+bool catReady = false;      // catalog file usable
+bool catWalking = false;    // background indexing in progress
+bool catSorting = false;    // - || -, walk done
+CatalogHeader catHeader = {0};
+
+// background walk: directory entry index of each directory entered, position within each of them
+BYTE walkDepth = 0;
+WORD walkIndex[MAX_DEPTH] = {0};
+DWORD walkPos[MAX_DEPTH] = {0};
+
+// background sort: runs of sortWidth entries merged pairwise, from catHeader.area into the other one
+WORD sortCount = 0;         // entries sorted
+WORD sortRecords = 0;       // records covered, those stored since are inserted once sorted
+WORD sortWidth = 0;
+WORD sortStart = 0;         // first entry of the pair of runs merged
+WORD sortLeft = 0;          // next entry of each run
+WORD sortRight = 0;
+WORD sortOut = 0;           // next entry written
+
+// images to insert, off the host's commands; one more while full: the card is walked again on its next insertion
+ImageLocator catQueue[CATALOG_QUEUE];
+BYTE catQueued = 0;
+bool catOverflow = false;
+
+bool catIsReady()
+{
+  return catReady;
+}
+
+bool catIsIndexing()
+{
+  return catWalking || catSorting;
+}
+
+bool catWriteHeader(File& cat)
+{
+  return cat.seekSet(0) && (cat.write(&catHeader, sizeof(catHeader)) == sizeof(catHeader));
+}
+
+DWORD catIndexAddress(BYTE area, WORD position)
+{
+  return CATALOG_INDEX + (area * (CATALOG_MAX_IMAGES * 2L)) + (position * 2L);
+}
+
+bool catReadIndex(File& cat, WORD position, WORD& number, BYTE area)
+{
+  return cat.seekSet(catIndexAddress(area, position)) && (cat.read(&number, 2) == 2);
+}
+
+bool catReadIndex(File& cat, WORD position, WORD& number)
+{
+  return catReadIndex(cat, position, number, catHeader.area);
+}
+
+bool catWriteIndex(File& cat, WORD position, WORD number, BYTE area)
+{
+  return cat.seekSet(catIndexAddress(area, position)) && (cat.write(&number, 2) == 2);
+}
+
+bool catReadNumber(File& cat, WORD number, CatalogRecord& record)
+{
+  return (number < catHeader.records) && cat.seekSet(CATALOG_RECORDS + ((DWORD)number * sizeof(CatalogRecord))) &&
+         (cat.read(&record, sizeof(CatalogRecord)) == sizeof(CatalogRecord));
+}
+
+bool catReadRecord(File& cat, WORD position, CatalogRecord& record)
+{
+  // by sorted position
+  WORD number;
+  return catReadIndex(cat, position, number) && catReadNumber(cat, number, record);
+}
+
+bool catSameImage(const CatalogRecord& first, const CatalogRecord& second)
+{
+  return (first.locator.depth == second.locator.depth) &&
+         (memcmp(first.locator.index, second.locator.index, first.locator.depth * sizeof(WORD)) == 0);
+}
+
+int catCompare(const CatalogRecord& first, const CatalogRecord& second)
+{
+  // by name, then by locator so that duplicates end up next to each other
+  const int compare = strncasecmp(first.name, second.name, CATALOG_NAME_LEN + 1);
+  if (compare || (first.locator.depth != second.locator.depth))
+  {
+    return compare ? compare : first.locator.depth - second.locator.depth;
+  }
+  
+  return memcmp(first.locator.index, second.locator.index, first.locator.depth * sizeof(WORD));
+}
+
+WORD catBound(File& cat, const char* name, BYTE length, bool upper)
+{
+  // first sorted position with its name (up to length) not below name; upper: above name
+  WORD low = 0;
+  WORD high = catHeader.count;
+  CatalogRecord record;
+  
+  while (low < high)
+  {
+    const WORD mid = (low + high) / 2;
+    if (!catReadRecord(cat, mid, record))
+    {
+      break;
+    }
+    
+    const int compare = strncasecmp(record.name, name, length);
+    if ((compare < 0) || (upper && (compare == 0)))
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid;
+    }
+  }
+  
+  return low;
+}
+
+bool catMoveIndex(File& cat, WORD from, WORD to, WORD count)
+{
+  // count entries within the index area in use, overlapping: from its end if moving up
+  const BYTE chunkEntries = 16;
+  const WORD arenaMark = Arena::mark();
+  WORD* chunk = Arena::alloc<WORD>(chunkEntries);
+  bool result = chunk;
+  
+  WORD done = 0;
+  while (result && (done < count))
+  {
+    const WORD length = ((count - done) > chunkEntries) ? chunkEntries : (count - done);
+    const WORD offset = (to > from) ? (count - done - length) : done;
+    done += length;
+    
+    result = cat.seekSet(catIndexAddress(catHeader.area, from + offset)) && (cat.read(chunk, length * 2) == (length * 2)) &&
+             cat.seekSet(catIndexAddress(catHeader.area, to + offset)) && (cat.write(chunk, length * 2) == (length * 2));
+  }
+  
+  Arena::release(arenaMark);
+  return result;
+}
+
+bool catAppend(File& cat, const CatalogRecord& record, WORD& number)
+{
+  number = catHeader.records;
+  if ((number == CATALOG_NEW) || !cat.seekSet(CATALOG_RECORDS + ((DWORD)number * sizeof(CatalogRecord))) ||
+      (cat.write(&record, sizeof(CatalogRecord)) != sizeof(CatalogRecord)))
+  {
+    return false;
+  }
+  
+  catHeader.records++;
+  return catWriteHeader(cat);
+}
+
+bool catInsert(File& cat, const CatalogRecord& record, WORD number)
+{
+  // number: where the record is stored already, CATALOG_NEW: not stored yet
+  // same name and locator already listed: update that record in place, or point to the newer one
+  WORD position = catBound(cat, record.name, CATALOG_NAME_LEN + 1, false);
+  for (; position < catHeader.count; position++)
+  {
+    CatalogRecord listed;
+    WORD listedNumber;
+    if (!catReadIndex(cat, position, listedNumber) || !catReadNumber(cat, listedNumber, listed))
+    {
+      return false;
+    }
+    if (strcasecmp(listed.name, record.name) != 0)
+    {
+      break;
+    }
+    
+    if (catSameImage(listed, record))
+    {
+      if (number != CATALOG_NEW)
+      {
+        return catWriteIndex(cat, position, number, catHeader.area);
+      }
+      return cat.seekSet(CATALOG_RECORDS + ((DWORD)listedNumber * sizeof(CatalogRecord))) &&
+             (cat.write(&record, sizeof(CatalogRecord)) == sizeof(CatalogRecord));
+    }
+  }
+  
+  // new one, after the last of the same name
+  if ((catHeader.count >= CATALOG_MAX_IMAGES) || ((number == CATALOG_NEW) && !catAppend(cat, record, number)))
+  {
+    return false;
+  }
+  
+  // make room in the index
+  if (!catMoveIndex(cat, position, position + 1, catHeader.count - position) ||
+      !catWriteIndex(cat, position, number, catHeader.area))
+  {
+    return false;
+  }
+  
+  catHeader.count++;
+  return catWriteHeader(cat);
+}
+
+bool catDrop(File& cat, WORD position)
+{
+  // index entry only, the record stays unreferenced
+  if ((position >= catHeader.count) || !catMoveIndex(cat, position + 1, position, catHeader.count - position - 1))
+  {
+    return false;
+  }
+  
+  catHeader.count--;
+  return catWriteHeader(cat);
+}
+
+void catBegin()
+{
+  // card (re)inserted: use its catalog, or index the card in the background if there is none yet
+  catReady = false;
+  catWalking = false;
+  catSorting = false;
+  catQueued = 0;
+  catOverflow = false;
+  
+  File cat = sd.open(CATALOG_FILE, O_RDWR | O_CREAT);
+  if (!cat)
+  {
+    return; // write protected card, etc.
+  }
+  
+  if ((cat.read(&catHeader, sizeof(catHeader)) == sizeof(catHeader)) && (catHeader.magic == CATALOG_MAGIC) &&
+      (catHeader.version == CATALOG_VERSION) && (catHeader.recordSize == sizeof(CatalogRecord)) &&
+      (catHeader.maxImages == CATALOG_MAX_IMAGES) && (catHeader.area < 2) && catHeader.complete)
+  {
+    cat.close();
+    catReady = true;
+    return;
+  }
+  
+  // start over, header and an empty index
+  memset(&catHeader, 0, sizeof(catHeader));
+  catHeader.magic = CATALOG_MAGIC;
+  catHeader.version = CATALOG_VERSION;
+  catHeader.recordSize = sizeof(CatalogRecord);
+  catHeader.maxImages = CATALOG_MAX_IMAGES;
+  
+  const BYTE bufSize = 64;
+  const WORD arenaMark = Arena::mark();
+  BYTE* buf = Arena::alloc<BYTE>(bufSize);
+  bool result = buf && cat.truncate(0);
+  if (result)
+  {
+    memset(buf, 0, bufSize);
+    for (WORD count = 0; result && (count < (CATALOG_RECORDS / bufSize)); count++)
+    {
+      result = cat.write(buf, bufSize) == bufSize;
+    }
+  }
+  Arena::release(arenaMark);
+  
+  result = result && catWriteHeader(cat);
+  cat.close();
+  if (!result)
+  {
+    return;
+  }
+  
+  catReady = true;
+  catWalking = true;
+  walkDepth = 0;
+  walkPos[0] = 0;
+}
+
+void catSortDone(File& cat)
+{
+  // images stored while sorting go in one at a time
+  catSorting = false;
+  for (WORD number = sortRecords; number < catHeader.records; number++)
+  {
+    CatalogRecord record;
+    if (!catReadNumber(cat, number, record) || !catInsert(cat, record, number))
+    {
+      break;
+    }
+  }
+  
+  catHeader.complete = 1;
+  catWriteHeader(cat);
+}
+
+void catSortBegin()
+{
+  // index in the order found, merged from runs of one entry
+  File cat = sd.open(CATALOG_FILE, O_RDWR);
+  if (!cat)
+  {
+    catReady = false;
+    return;
+  }
+  
+  catHeader.area = 0;
+  catHeader.count = (catHeader.records > CATALOG_MAX_IMAGES) ? CATALOG_MAX_IMAGES : catHeader.records;
+  bool result = cat.seekSet(catIndexAddress(0, 0));
+  for (WORD number = 0; result && (number < catHeader.count); number++)
+  {
+    result = cat.write(&number, 2) == 2;
+  }
+  
+  sortCount = catHeader.count;
+  sortRecords = catHeader.count;
+  sortWidth = 1;
+  sortStart = 0;
+  sortLeft = 0;
+  sortRight = 1;
+  sortOut = 0;
+  
+  catSorting = result && (sortCount > 1);
+  if (result && !catSorting)
+  {
+    catSortDone(cat);
+  }
+  cat.close();
+}
+
+void catSortStep()
+{
+  // a few entries of a merge pass; the last one drops a record listed twice, keeping the one stored later
+  File cat = sd.open(CATALOG_FILE, O_RDWR);
+  const WORD arenaMark = Arena::mark();
+  CatalogRecord* heads = Arena::alloc<CatalogRecord>(3); // left, right, last written
+  if (!cat || !heads)
+  {
+    Arena::release(arenaMark);
+    catSorting = false;  // stays incomplete, rebuilt on the next insertion
+    return;
+  }
+  
+  const BYTE from = catHeader.area;
+  const BYTE to = from ^ 1;
+  const bool lastPass = ((DWORD)sortWidth * 2) >= sortCount;
+  WORD leftNumber = CATALOG_NEW;
+  WORD rightNumber = CATALOG_NEW;
+  bool result = true;
+  
+  for (BYTE step = 0; result && (step < CATALOG_STEP); step++)
+  {
+    const WORD middle = (((DWORD)sortStart + sortWidth) < sortCount) ? (sortStart + sortWidth) : sortCount;
+    const WORD end = (((DWORD)sortStart + (2L * sortWidth)) < sortCount) ? (sortStart + (2 * sortWidth)) : sortCount;
+    
+    // pair of runs merged: the next one, or the next pass
+    if ((sortLeft >= middle) && (sortRight >= end))
+    {
+      sortStart = end;
+      if (sortStart >= sortCount)
+      {
+        catHeader.area = to; // the next pass is read from there
+        if (lastPass)
+        {
+          catHeader.count = sortOut;
+          catSortDone(cat);
+          break;
+        }
+        
+        sortWidth *= 2;
+        sortStart = 0;
+        sortOut = 0;
+        sortLeft = 0;
+        sortRight = (sortWidth < sortCount) ? sortWidth : sortCount;
+        break;
+      }
+      
+      sortLeft = sortStart;
+      sortRight = (((DWORD)sortStart + sortWidth) < sortCount) ? (sortStart + sortWidth) : sortCount;
+      leftNumber = CATALOG_NEW;
+      rightNumber = CATALOG_NEW;
+      continue;
+    }
+    
+    // heads of both runs, read once each
+    if ((sortLeft < middle) && (leftNumber == CATALOG_NEW))
+    {
+      result = catReadIndex(cat, sortLeft, leftNumber, from) && catReadNumber(cat, leftNumber, heads[0]);
+    }
+    if (result && (sortRight < end) && (rightNumber == CATALOG_NEW))
+    {
+      result = catReadIndex(cat, sortRight, rightNumber, from) && catReadNumber(cat, rightNumber, heads[1]);
+    }
+    if (!result)
+    {
+      break;
+    }
+    
+    // the left one on a tie, the sort is stable
+    const bool left = (sortRight >= end) || ((sortLeft < middle) && (catCompare(heads[0], heads[1]) <= 0));
+    const WORD number = left ? leftNumber : rightNumber;
+    const CatalogRecord& record = heads[left ? 0 : 1];
+    
+    WORD lastNumber;
+    if (lastPass && sortOut && catReadIndex(cat, sortOut - 1, lastNumber, to) && catReadNumber(cat, lastNumber, heads[2]) &&
+        (strcasecmp(heads[2].name, record.name) == 0) && catSameImage(heads[2], record))
+    {
+      sortOut--;
+    }
+    result = catWriteIndex(cat, sortOut++, number, to);
+    
+    if (left)
+    {
+      sortLeft++;
+      leftNumber = CATALOG_NEW;
+    }
+    else
+    {
+      sortRight++;
+      rightNumber = CATALOG_NEW;
+    }
+  }
+  
+  Arena::release(arenaMark);
+  cat.close();
+  if (!result)
+  {
+    catSorting = false;
+  }
+}
+
+void catStoreImage(const ImageLocator& locator, File& file);
+
+void catProcess()
+{
+  // background indexing, a few directory entries or sorted entries per pass; queued images first
+  if (catQueued)
+  {
+    File file;
+    if (fsOpenLocator(catQueue[0], file, O_RDONLY))
+    {
+      catStoreImage(catQueue[0], file);
+      file.close();
+    }
+    
+    catQueued--;
+    memmove(&catQueue[0], &catQueue[1], catQueued * sizeof(ImageLocator));
+    return;
+  }
+  if (catOverflow)
+  {
+    catOverflow = false;
+    File cat = sd.open(CATALOG_FILE, O_RDWR);
+    catHeader.complete = 0; // searched as it is until then
+    if (cat)
+    {
+      catWriteHeader(cat);
+      cat.close();
+    }
+    return;
+  }
+  if (catSorting)
+  {
+    catSortStep();
+    return;
+  }
+  if (!catWalking)
+  {
+    return;
+  }
+  
+  ImageLocator dirLocator = {0};
+  dirLocator.depth = walkDepth;
+  memcpy(dirLocator.index, walkIndex, sizeof(walkIndex));
+  
+  File dir;
+  if (walkDepth)
+  {
+    fsOpenLocator(dirLocator, dir, O_RDONLY);
+  }
+  else
+  {
+    dir = sd.open("/", O_RDONLY);
+  }
+  
+  // card changed under us, the catalog stays incomplete and is rebuilt on the next insertion
+  if (!dir || !dir.seekSet(walkPos[walkDepth]))
+  {
+    catWalking = false;
+    return;
+  }
+  
+  for (BYTE entry = 0; entry < 8; entry++)
+  {
+    File file = dir.openNextFile(O_RDONLY);
+    
+    // end of this directory, back to the parent one
+    if (!file)
+    {
+      if (walkDepth)
+      {
+        walkDepth--;
+        return;
+      }
+      
+      // all found, sorted next
+      catWalking = false;
+      catSortBegin();
+      return;
+    }
+    
+    if (file.isHidden())
+    {
+      file.close();
+      continue;
+    }
+    
+    // enter subdirectory, this one resumes afterwards
+    if (file.isDir() || file.isSubDir())
+    {
+      if (walkDepth < MAX_DEPTH-1) // room for the image itself
+      {
+        walkIndex[walkDepth] = file.dirIndex();
+        walkPos[walkDepth] = dir.curPosition();
+        walkDepth++;
+        walkPos[walkDepth] = 0;
+        
+        file.close();
+        return;
+      }
+      
+      file.close();
+      continue;
+    }
+    
+    char name[MAX_PATH + 1];
+    name[0] = 0;
+    file.getName(name, MAX_PATH);
+    if (fsIsImageName(name))
+    {
+      ImageLocator locator = dirLocator;
+      locator.index[locator.depth++] = file.dirIndex();
+      locator.sector = file.firstSector();
+      catStoreImage(locator, file);
+    }
+    file.close();
+  }
+  
+  walkPos[walkDepth] = dir.curPosition();
+}
+
+void catAddImage(const ImageLocator& locator)
+{
+  // image created or mounted: queued, the catalog file is not touched during a host command
+  if (!catReady || !locator.depth)
+  {
+    return;
+  }
+  
+  if (catQueued == CATALOG_QUEUE)
+  {
+    catOverflow = true;
+    return;
+  }
+  catQueue[catQueued++] = locator;
+}
+
+void catStoreImage(const ImageLocator& locator, File& file)
+{
+  // add or update an image found, created or mounted
+  if (!catReady || !locator.depth)
+  {
+    return;
+  }
+  
+  char name[MAX_PATH + 1];
+  name[0] = 0;
+  if (!file.getName(name, MAX_PATH))
+  {
+    return;
+  }
+  
+  CatalogRecord record;
+  memset(&record, 0, sizeof(record));
+  record.locator = locator;
+  strncpy(record.name, name, CATALOG_NAME_LEN);
+  record.size = file.fileSize();
+  record.valid = (record.size == 368640L) ? 1 : 0;
+  
+  File cat = sd.open(CATALOG_FILE, O_RDWR);
+  if (!cat)
+  {
+    catReady = false;
+    return;
+  }
+  
+  // while indexing only stored, sorted in or left out as a duplicate later
+  WORD number;
+  if (catWalking || catSorting)
+  {
+    catAppend(cat, record, number);
+  }
+  else
+  {
+    catInsert(cat, record, CATALOG_NEW);
+  }
+  cat.close();
+}
+
+WORD catFind(const char* prefix, WORD& count)
+{
+  // sorted position of the first image with name starting with prefix (case-insensitive), count of such
+  count = 0;
+  if (!catReady || catSorting || !prefix)
+  {
+    return 0;
+  }
+  
+  File cat = sd.open(CATALOG_FILE, O_RDONLY);
+  if (!cat)
+  {
+    return 0;
+  }
+  
+  const BYTE length = (strlen(prefix) > CATALOG_NAME_LEN) ? CATALOG_NAME_LEN : strlen(prefix);
+  const WORD first = catBound(cat, prefix, length, false);
+  count = catBound(cat, prefix, length, true) - first;
+  
+  cat.close();
+  return first;
+}
+
+bool catGetRecord(WORD position, CatalogRecord& record)
+{
+  if (!catReady || catSorting || (position >= catHeader.count))
+  {
+    return false;
+  }
+  
+  File cat = sd.open(CATALOG_FILE, O_RDONLY);
+  if (!cat)
+  {
+    return false;
+  }
+  
+  const bool result = catReadRecord(cat, position, record);
+  cat.close();
+  return result;
+}
+
+bool catResolve(WORD position, CatalogRecord& record, char* path, WORD size)
+{
+  // record at the sorted position and the full path of its image; false if it is gone,
+  // or renamed: its record is then dropped from the index and the positions after it move up by one
+  if (!catGetRecord(position, record))
+  {
+    return false;
+  }
+  
+  if (fsGetLocatorPath(record.locator, path, size))
+  {
+    const char* name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    if (strncasecmp(name, record.name, CATALOG_NAME_LEN) == 0)
+    {
+      return true;
+    }
+  }
+  
+  // still there, only its path does not fit: kept
+  else
+  {
+    File file;
+    if (fsOpenLocator(record.locator, file, O_RDONLY))
+    {
+      file.close();
+      return false;
+    }
+  }
+  
+  File cat = sd.open(CATALOG_FILE, O_RDWR);
+  if (cat)
+  {
+    catDrop(cat, position);
+    cat.close();
+  }
+  return false;
+}
+
+#endif // TOUCH_SCREEN_CALIBRATION
@@ -0,0 +1,28 @@
+// PMD32-Mega2560 (c) 2025 J. Bogin, https://boginjr.com
+// Based on PMD32-SD (c) 2012 R. Borik, https://pmd85.borik.net/
+// Card-wide image catalog
+
+#pragma once
+#include "config.h"
+
+#define CATALOG_FILE       "/PMD32.CAT"
+#define CATALOG_MAX_IMAGES 1024 // sorted index entries, fixed part of the file
+#define CATALOG_NAME_LEN   32   // longer image names are truncated
+
+struct CatalogRecord
+{
+  ImageLocator locator;
+  char name[CATALOG_NAME_LEN + 1];
+  DWORD size;
+  BYTE valid;               // 1: 360K image
+  BYTE reserved[64 - sizeof(ImageLocator) - (CATALOG_NAME_LEN + 1) - sizeof(DWORD) - 1];
+};
+
+void catBegin();
+bool catIsReady();
+bool catIsIndexing();
+void catProcess();
+void catAddImage(const ImageLocator& locator);
+WORD catFind(const char* prefix, WORD& count);
+bool catGetRecord(WORD position, CatalogRecord& record);
+bool catResolve(WORD position, CatalogRecord& record, char* path, WORD size);
@@ -6,19 +6,36 @@
 
 // if uncommented, touchscreen is connected via an XPT2046 controller (HR2046 etc)
 // commented: passive touchscreen with pins X+, Y+, X-, Y-
+// it is sampled from the timer 0 compare match A interrupt (OCR0A), so analogWrite() on pin 13 is not available
 #define TOUCH_SCREEN_ACTIVE
 
+// passive touchscreen only: if uncommented, sample it through the port and ADC registers
+// commented: through the Adafruit TouchScreen library
+#define TOUCH_SCREEN_PASSIVE_FAST
+
 // if uncommented, run touchscreen "calibration mode"
-// run if the hits are imprecise, or their direction is wrong (left-right, up-down)
+// run if the hits are imprecise, or their direction is wrong (left-right, up-down);
+// the same calibration runs from the firmware if the screen is held while powering up
 //#define TOUCH_SCREEN_CALIBRATION
 
 // if uncommented, rotate display by 180°
 //#define DISP_FLIP_ORIENTATION
 
 // if uncommented, store paths of successfully mounted images into EEPROM
-// and try to auto-mount them upon next board powerup
+// and try to auto-mount them upon next board powerup (journal of the first 2K, written in the background)
 #define EEPROM_IMAGE_AUTOMOUNT
 
+// if uncommented, the idle page shows drive activity and throughput instead of buffer use and boot times
+#define UI_DASHBOARD
+
+// if uncommented, time each PMD32 command phase into histograms, ~800 bytes of RAM and timer 1,
+// with the serial port buffers (~160 bytes) ~960 bytes;
+// read out by the 'V' command, or over the serial port at 115200 ('h' to print, 'r' to reset)
+//#define PMD32_LATENCY
+
+// if uncommented, the idle page without UI_DASHBOARD also shows the peak use of the buffer arena (arena.h)
+//#define DEBUG_ARENA_USAGE
+
 // if uncommented, use software SPI for SD card
 // example: 8-bit Uno display shield with SD pins fixed on 10-13 instead of 50-53
 // with this on, SPI_DRIVER_SELECT inside SdFat/SdFatConfig.h must be set to 2
@@ -69,11 +86,12 @@
 #include <avr/sfr_defs.h>
 #include <string.h>
 #include <EEPROM.h>
+#include <util/crc16.h>
 
 // default configuration: 320x240 TFT (16-bit parallel), microSD interface (HW SPI on pins 50-53), active touchscreen
 
 // alternate configuration examples:
-// (1) 16bit HX8347-I: as default, only DISP_ID_16BIT changed to 0x9595 
+// (1) 16bit HX8347-I: as default, only DISP_ID_16BIT and MCUFRIEND_STATIC_ID in mcufriend_special.h changed to 0x9595 
 // (2) 8bit Uno shield, passive touch, SD on pins 10-13: comment USE_MEGA_16BIT_SHIELD in mcufriend_special.h,
 //                                                       set SPI_DRIVER_SELECT 2 in SdFatConfig.h,
 //                                                       comment TOUCH_SCREEN_ACTIVE and uncomment SD_SOFTWARE_SPI here
@@ -86,8 +104,12 @@
 #include "src/MCUFRIEND_kbv/MCUFRIEND_kbv.h"
 #include "src/MCUFRIEND_kbv/utility/mcufriend_special.h"
 
-// touchscreen calibration
-// to respecify, uncomment TOUCH_SCREEN_CALIBRATION
+#if defined(MCUFRIEND_STATIC_ID) && (MCUFRIEND_STATIC_ID != DISP_ID_16BIT)
+  #error MCUFRIEND_STATIC_ID in mcufriend_special.h must match DISP_ID_16BIT
+#endif
+
+// touchscreen calibration, used until one is stored in EEPROM
+// to respecify, uncomment TOUCH_SCREEN_CALIBRATION or hold the screen while powering up
 #define TOUCH_CAL_X1     72 
 #define TOUCH_CAL_Y1     96
 #define TOUCH_CAL_X2     919
@@ -105,8 +127,11 @@
   #define TOUCH_YPLUS    A3     // Y+, YP
   #define TOUCH_XMINUS   A2     // X-, XM
   #define TOUCH_YMINUS   9      // Y-, YM
-  #define TOUCH_RX       325    // resistance between XP-XM in ohms
+  #define TOUCH_RX       325    // resistance between XP-XM in ohms (Adafruit library only)
   #include <TouchScreen.h>      // Adafruit
+  #ifdef TOUCH_SCREEN_PASSIVE_FAST
+    #include "src/TouchScreen_Fast/TouchScreen_Fast.h"
+  #endif
 #endif
 
 // SD
@@ -130,9 +155,12 @@
 
 // our common includes
 #include "progmem.h"
+#include "arena.h"
 #include "touch.h"
 #include "ui.h"
 #include "filesystem.h"
+#include "catalog.h"
+#include "dirview.h"
 #include "pmd32.h"
 
 // public globals
@@ -0,0 +1,523 @@
+// PMD32-Mega2560 (c) 2025 J. Bogin, https://boginjr.com
+// Based on PMD32-SD (c) 2012 R. Borik, https://pmd85.borik.net/
+// Sorted directory views
+
+#include "config.h"
+
+#ifndef TOUCH_SCREEN_CALIBRATION
+
+// view file, one per slot:
+// +0, 64:   header (DirViewHeader)
+// +64, ..:  sorted entries, DirViewEntry each
+//
+// a view is built by an external merge sort, as there is no room to sort in RAM:
+// sorted runs of DIRVIEW_RUN entries are streamed to a file, then merged DIRVIEW_WAYS at a time,
+// each pass from one file into the other (/PMD32.TMP and the view), until a single run is left.
+// a directory changed since its view was built is told by the fingerprint of its raw entries
+
+#define DIRVIEW_MAGIC   0x56533250 // "P2SV"
+#define DIRVIEW_DATA    64L
+#define DIRVIEW_TMP     "/PMD32.TMP"
+#define DIRVIEW_RUN     16  // entries sorted in RAM
+#define DIRVIEW_WAYS    4   // runs merged at once
+#define DIRVIEW_IN_BUF  2   // entries buffered per merged run
+#define DIRVIEW_OUT_BUF 8   // entries buffered for writing
+
+#define DIRVIEW_DIRECTORY 1
+#define DIRVIEW_IMAGE     2
+
+struct DirViewEntry
+{
+  char key[DIRVIEW_KEY_LEN]; // not terminated if the name is as long
+  BYTE flags;
+  WORD index;                // directory entry index
+};
+
+struct DirViewHeader
+{
+  DWORD magic;
+  DWORD dirSector;           // first sector of the directory
+  WORD fingerprint;          // CRC16 of the raw directory entries
+  WORD entries;              // visible raw entries at the time
+  WORD count;
+  WORD pickerCount;
+};
+
+// slot headers, loaded on first use after the card was inserted
+DirViewHeader dvSlots[DIRVIEW_SLOTS];
+DWORD dvUsed[DIRVIEW_SLOTS];
+BYTE dvGeneration[DIRVIEW_SLOTS];
+BYTE dvPinned = DIRVIEW_SLOTS; // shown by the file picker
+bool dvLoaded = false;
+
+void dvSlotFile(BYTE slot, char* path)
+{
+  strcpy(path, "/PMD32.SV0");
+  path[9] += slot;
+}
+
+void dvBegin()
+{
+  // card (re)inserted
+  dvLoaded = false;
+}
+
+void dvLoad()
+{
+  for (BYTE slot = 0; slot < DIRVIEW_SLOTS; slot++)
+  {
+    memset(&dvSlots[slot], 0, sizeof(DirViewHeader));
+    dvUsed[slot] = 0;
+    dvGeneration[slot]++;
+    
+    char path[11];
+    dvSlotFile(slot, path);
+    File file = sd.open(path, O_RDONLY);
+    if (file)
+    {
+      if ((file.read(&dvSlots[slot], sizeof(DirViewHeader)) != sizeof(DirViewHeader)) || (dvSlots[slot].magic != DIRVIEW_MAGIC))
+      {
+        dvSlots[slot].magic = 0;
+      }
+      file.close();
+    }
+  }
+  
+  dvLoaded = true;
+}
+
+void dvFingerprintExFat(File& dir, WORD& fingerprint, WORD& entries)
+{
+  // exFAT entry sets: file (0x85), stream extension (0xC0), then names (0xC1) of 15 UCS-2 characters each;
+  // types, attributes and names, not the sizes and times that change as an image is written
+  WORD setStart = fingerprint;  // before the set, restored if it is one of our own files
+  BYTE secondary = 0;           // entries of the set still to come
+  bool hidden = false;
+  bool named = false;
+  BYTE nameLength = 0;
+  
+  BYTE entry[32];
+  while (dir.read(entry, sizeof(entry)) == sizeof(entry))
+  {
+    const BYTE type = entry[0];
+    if (type == 0) // end of directory
+    {
+      break;
+    }
+    
+    if (type == 0x85)
+    {
+      setStart = fingerprint;
+      secondary = entry[1];
+      hidden = entry[4] & 0x02;
+      named = false;
+      nameLength = 0;
+      
+      fingerprint = _crc16_update(fingerprint, type);
+      fingerprint = _crc16_update(fingerprint, entry[1]);
+      fingerprint = _crc16_update(fingerprint, entry[4]);
+      fingerprint = _crc16_update(fingerprint, entry[5]);
+      continue;
+    }
+    
+    // deleted, or not part of a file (allocation bitmap, up-case table, volume label)
+    if (!(type & 0x80) || !secondary)
+    {
+      continue;
+    }
+    secondary--;
+    
+    if (type == 0xC0)
+    {
+      nameLength = entry[3];
+      fingerprint = _crc16_update(fingerprint, nameLength);
+    }
+    else if (type == 0xC1)
+    {
+      // our own files told by the first name part
+      if (!named)
+      {
+        named = true;
+        
+        char part[15];
+        for (BYTE index = 0; index < sizeof(part); index++)
+        {
+          part[index] = entry[3 + index * 2] ? '?' : entry[2 + index * 2];
+        }
+        if (fsIsInternalName(dir, part, nameLength))
+        {
+          fingerprint = setStart;
+          secondary = 0;
+          continue;
+        }
+        if (!hidden)
+        {
+          entries++;
+        }
+      }
+      
+      for (BYTE index = 2; index < sizeof(entry); index++)
+      {
+        fingerprint = _crc16_update(fingerprint, entry[index]);
+      }
+    }
+  }
+}
+
+bool dvFingerprint(File& dir, WORD& fingerprint, WORD& entries)
+{
+  // raw directory entries: names and attributes of all in use, including long name parts
+  // no files opened, no long names assembled
+  fingerprint = 0xFFFF;
+  entries = 0;
+  
+  if (!dir.seekSet(0))
+  {
+    return false;
+  }
+  
+  if (sd.fatType() == FAT_TYPE_EXFAT)
+  {
+    dvFingerprintExFat(dir, fingerprint, entries);
+    return dir.seekSet(0);
+  }
+  
+  BYTE entry[32];
+  while (dir.read(entry, sizeof(entry)) == sizeof(entry))
+  {
+    if (entry[0] == 0) // end of directory
+    {
+      break;
+    }
+    // deleted, or our own files, rewritten while views are built
+    if ((entry[0] == 0xE5) || fsIsInternalEntry(dir, entry))
+    {
+      continue;
+    }
+    
+    for (BYTE index = 0; index < 12; index++)
+    {
+      fingerprint = _crc16_update(fingerprint, entry[index]);
+    }
+    
+    // long name part, volume label, hidden, . or ..
+    const BYTE attributes = entry[11];
+    if (((attributes & 0x0F) == 0x0F) || (attributes & 0x0A) || (entry[0] == '.'))
+    {
+      continue;
+    }
+    entries++;
+  }
+  
+  return dir.seekSet(0);
+}
+
+char dvRank(const DirViewEntry& entry)
+{
+  return (entry.flags & DIRVIEW_DIRECTORY) ? 0 : ((entry.flags & DIRVIEW_IMAGE) ? 1 : 2);
+}
+
+int dvCompare(const DirViewEntry& first, const DirViewEntry& second)
+{
+  const char rank = dvRank(first) - dvRank(second);
+  return rank ? rank : strncasecmp(first.key, second.key, DIRVIEW_KEY_LEN);
+}
+
+bool dvWriteRuns(File& dir, File& out, WORD& count, WORD& pickerCount)
+{
+  // pass 0: sorted runs of DIRVIEW_RUN entries
+  count = 0;
+  pickerCount = 0;
+  
+  const WORD arenaMark = Arena::mark();
+  DirViewEntry* run = Arena::alloc<DirViewEntry>(DIRVIEW_RUN);
+  if (!run || !out.seekSet(DIRVIEW_DATA))
+  {
+    Arena::release(arenaMark);
+    return false;
+  }
+  
+  bool result = true;
+  BYTE inRun = 0;
+  while (result)
+  {
+    RawDirEntry raw;
+    const bool done = !fsReadRawEntry(dir, raw);
+    if (!done && raw.isHidden)
+    {
+      continue;
+    }
+    
+    if (!done)
+    {
+      char name[MAX_PATH + 1];
+      fsGetRawEntryName(dir, raw, name, sizeof(name));
+      
+      // insertion sort
+      DirViewEntry entry;
+      strncpy(entry.key, name, DIRVIEW_KEY_LEN);
+      entry.flags = raw.isDirectory ? DIRVIEW_DIRECTORY : (raw.isImage ? DIRVIEW_IMAGE : 0);
+      entry.index = raw.index;
+      
+      BYTE at = inRun++;
+      for (; at && (dvCompare(run[at-1], entry) > 0); at--)
+      {
+        run[at] = run[at-1];
+      }
+      run[at] = entry;
+      
+      count++;
+      if (entry.flags)
+      {
+        pickerCount++;
+      }
+      if (count == 0xFFFF)
+      {
+        result = false;
+      }
+    }
+    
+    // run full or directory done
+    if (inRun && (done || (inRun == DIRVIEW_RUN)))
+    {
+      result = result && (out.write(run, inRun * sizeof(DirViewEntry)) == (inRun * sizeof(DirViewEntry)));
+      inRun = 0;
+    }
+    if (done)
+    {
+      break;
+    }
+  }
+  
+  Arena::release(arenaMark);
+  return result;
+}
+
+bool dvMerge(File& in, File& out, WORD count, WORD runLength)
+{
+  // one pass: each DIRVIEW_WAYS consecutive runs of in into one run of out
+  const WORD arenaMark = Arena::mark();
+  DirViewEntry* buffer = Arena::alloc<DirViewEntry>(DIRVIEW_WAYS * DIRVIEW_IN_BUF);
+  DirViewEntry* output = Arena::alloc<DirViewEntry>(DIRVIEW_OUT_BUF);
+  bool result = buffer && output && out.seekSet(DIRVIEW_DATA);
+  
+  WORD next[DIRVIEW_WAYS]; // next entry of the run to buffer
+  WORD end[DIRVIEW_WAYS];
+  BYTE at[DIRVIEW_WAYS];   // buffered entries taken
+  BYTE have[DIRVIEW_WAYS]; // entries buffered
+  BYTE outputCount = 0;
+  
+  for (DWORD first = 0; result && (first < count); first += (DWORD)runLength * DIRVIEW_WAYS)
+  {
+    for (BYTE way = 0; way < DIRVIEW_WAYS; way++)
+    {
+      const DWORD start = first + ((DWORD)way * runLength);
+      next[way] = (start < count) ? start : count;
+      end[way] = ((start + runLength) < count) ? (start + runLength) : count;
+      at[way] = 0;
+      have[way] = 0;
+    }
+    
+    while (result)
+    {
+      // refill, pick the lowest head
+      BYTE lowest = DIRVIEW_WAYS;
+      for (BYTE way = 0; way < DIRVIEW_WAYS; way++)
+      {
+        DirViewEntry* ways = &buffer[way * DIRVIEW_IN_BUF];
+        if ((at[way] == have[way]) && (next[way] < end[way]))
+        {
+          have[way] = ((end[way] - next[way]) > DIRVIEW_IN_BUF) ? DIRVIEW_IN_BUF : (end[way] - next[way]);
+          at[way] = 0;
+          
+          const WORD bytes = have[way] * sizeof(DirViewEntry);
+          result = in.seekSet(DIRVIEW_DATA + ((DWORD)next[way] * sizeof(DirViewEntry))) && (in.read(ways, bytes) == bytes);
+          next[way] += have[way];
+        }
+        
+        if ((at[way] < have[way]) &&
+            ((lowest == DIRVIEW_WAYS) || (dvCompare(ways[at[way]], buffer[(lowest * DIRVIEW_IN_BUF) + at[lowest]]) < 0)))
+        {
+          lowest = way;
+        }
+      }
+      
+      if (!result || (lowest == DIRVIEW_WAYS))
+      {
+        break;
+      }
+      
+      output[outputCount++] = buffer[(lowest * DIRVIEW_IN_BUF) + at[lowest]++];
+      if (outputCount == DIRVIEW_OUT_BUF)
+      {
+        result = out.write(output, outputCount * sizeof(DirViewEntry)) == (outputCount * sizeof(DirViewEntry));
+        outputCount = 0;
+      }
+    }
+  }
+  
+  if (result && outputCount)
+  {
+    result = out.write(output, outputCount * sizeof(DirViewEntry)) == (outputCount * sizeof(DirViewEntry));
+  }
+  
+  Arena::release(arenaMark);
+  return result;
+}
+
+bool dvBuild(BYTE slot, File& dir, DirViewHeader& header)
+{
+  char path[11];
+  dvSlotFile(slot, path);
+  File view = sd.open(path, O_RDWR | O_CREAT | O_TRUNC);
+  File tmp = sd.open(DIRVIEW_TMP, O_RDWR | O_CREAT | O_TRUNC);
+  if (!view || !tmp)
+  {
+    return false;
+  }
+  
+  // view invalid until done; both files need the header area to seek past
+  BYTE empty[DIRVIEW_DATA] = {0};
+  bool result = (view.write(empty, sizeof(empty)) == sizeof(empty)) && (tmp.write(empty, sizeof(empty)) == sizeof(empty));
+  
+  // merge passes needed, so that the last one ends in the view
+  BYTE passes = 0;
+  for (DWORD runs = ((DWORD)header.entries + DIRVIEW_RUN - 1) / DIRVIEW_RUN; runs > 1; runs = (runs + DIRVIEW_WAYS - 1) / DIRVIEW_WAYS)
+  {
+    passes++;
+  }
+  
+  File* in = (passes & 1) ? &tmp : &view;
+  File* out = (passes & 1) ? &view : &tmp;
+  result = result && dvWriteRuns(dir, *in, header.count, header.pickerCount);
+  
+  for (DWORD runLength = DIRVIEW_RUN; result && (runLength < header.count); runLength *= DIRVIEW_WAYS)
+  {
+    result = dvMerge(*in, *out, header.count, runLength);
+    
+    File* swap = in;
+    in = out;
+    out = swap;
+  }
+  
+  // entry count changed while listing, so did the number of passes
+  if (result && (in != &view))
+  {
+    result = false;
+  }
+  
+  header.magic = DIRVIEW_MAGIC;
+  result = result && view.seekSet(0) && (view.write(&header, sizeof(header)) == sizeof(header));
+  
+  tmp.truncate(0);
+  tmp.close();
+  view.close();
+  return result;
+}
+
+bool dvOpen(File& dir, DirView& view, bool build)
+{
+  // sorted view of an open directory, (re)built if it changed or was not cached
+  // build FALSE: only check if there is a current one
+  if (!dvLoaded)
+  {
+    dvLoad();
+  }
+  
+  DirViewHeader header = {0};
+  header.dirSector = dir.firstSector();
+  if (!dvFingerprint(dir, header.fingerprint, header.entries))
+  {
+    return false;
+  }
+  
+  // cached, or the least recently used slot to rebuild, other than the pinned one
+  BYTE slot = dvPinned ? 0 : 1;
+  for (BYTE index = 0; index < DIRVIEW_SLOTS; index++)
+  {
+    const DirViewHeader& cached = dvSlots[index];
+    if (cached.magic && (cached.dirSector == header.dirSector) && (cached.fingerprint == header.fingerprint) && (cached.entries == header.entries))
+    {
+      slot = index;
+      header = cached;
+      break;
+    }
+    
+    if ((index != dvPinned) && (dvUsed[index] < dvUsed[slot]))
+    {
+      slot = index;
+    }
+  }
+  
+  if (header.magic != DIRVIEW_MAGIC)
+  {
+    if (!build)
+    {
+      return false;
+    }
+    
+    dvGeneration[slot]++;
+    dvSlots[slot].magic = 0;
+    if (!dvBuild(slot, dir, header))
+    {
+      dir.seekSet(0);
+      return false;
+    }
+    dvSlots[slot] = header;
+  }
+  
+  dvUsed[slot] = millis() | 1;
+  dir.seekSet(0);
+  
+  view.slot = slot;
+  view.generation = dvGeneration[slot];
+  view.count = header.count;
+  view.pickerCount = header.pickerCount;
+  return true;
+}
+
+void dvPin(const DirView* view)
+{
+  dvPinned = view ? view->slot : DIRVIEW_SLOTS;
+}
+
+bool dvIsValid(const DirView& view)
+{
+  return dvLoaded && (view.slot < DIRVIEW_SLOTS) && (view.generation == dvGeneration[view.slot]) && dvSlots[view.slot].magic;
+}
+
+bool dvGetEntry(const DirView& view, File& dir, WORD position, char* name, WORD size, bool& isDirectory)
+{
+  // entry at the sorted position: full name, directory flag
+  if (!dvIsValid(view) || (position >= view.count) || !name || (size < 2))
+  {
+    return false;
+  }
+  
+  char path[11];
+  dvSlotFile(view.slot, path);
+  File file = sd.open(path, O_RDONLY);
+  
+  DirViewEntry entry;
+  if (!file || !file.seekSet(DIRVIEW_DATA + ((DWORD)position * sizeof(DirViewEntry))) || (file.read(&entry, sizeof(entry)) != sizeof(entry)))
+  {
+    return false;
+  }
+  file.close();
+  
+  isDirectory = entry.flags & DIRVIEW_DIRECTORY;
+  
+  // long name only for the entries actually shown, the key if that fails
+  name[0] = 0;
+  if (!file.open(&dir, entry.index, O_RDONLY) || !file.getName(name, size))
+  {
+    const WORD length = ((size - 1) < DIRVIEW_KEY_LEN) ? (size - 1) : DIRVIEW_KEY_LEN;
+    memcpy(name, entry.key, length);
+    name[length] = 0;
+  }
+  file.close();
+  
+  return true;
+}
+
+#endif // TOUCH_SCREEN_CALIBRATION
@@ -0,0 +1,25 @@
+// PMD32-Mega2560 (c) 2025 J. Bogin, https://boginjr.com
+// Based on PMD32-SD (c) 2012 R. Borik, https://pmd85.borik.net/
+// Sorted directory views
+
+#pragma once
+#include "config.h"
+
+#define DIRVIEW_SLOTS   4   // directories cached, files /PMD32.SV0 to .SV3
+#define DIRVIEW_KEY_LEN 29  // sort key, the long name truncated
+
+// handle to a sorted view of one directory:
+// directories first, then *.p32 images, then other files, each by name (case-insensitive)
+struct DirView
+{
+  BYTE slot;
+  BYTE generation;          // the slot was not rebuilt for another directory since
+  WORD count;               // entries, hidden ones excluded
+  WORD pickerCount;         // directories and images, listed first
+};
+
+void dvBegin();
+bool dvOpen(File& dir, DirView& view, bool build = true);
+bool dvIsValid(const DirView& view);
+void dvPin(const DirView* view);  // kept from being replaced by views of other directories, NULL: none
+bool dvGetEntry(const DirView& view, File& dir, WORD position, char* name, WORD size, bool& isDirectory);
@@ -0,0 +1,116 @@
+// Host simulation of the MCUFRIEND_kbv fill and glyph kernels on the Mega2560 bus.
+//
+// The GPIO ports are modelled (stub/avr/io.h) and the display side latches the data
+// lines on every WR rising edge. Each test checks that the latched pixels, high byte
+// first, are exactly the colours asked for, that WR strobes once per pixel on the
+// 16-bit shield and twice on an 8-bit one, and prints the data-port stores it took.
+// run.sh builds and runs both bus widths against ../../src/MCUFRIEND_kbv.
+#include <stdio.h>
+#include "MCUFRIEND_kbv.h"
+
+Port ports[33];
+static std::vector<uint16_t> latched;
+static long strobes, dataStores;
+static uint8_t highByte;
+static bool haveHigh;
+
+void Port::set(uint8_t n)
+{
+  uint8_t old = v;
+  v = n;
+#if BUS16
+  // USE_MEGA_16BIT_SHIELD: D15-D8 on PORTA, D7-D0 on PORTC, WR on PG2
+  if (this == &PORTA || this == &PORTC)
+    dataStores++;
+  if (this == &PORTG && !(old & 4) && (n & 4))
+  {
+    strobes++;
+    latched.push_back((PORTA.v << 8) | PORTC.v);
+  }
+#else
+  // Uno shield on a Mega: D0-D7 spread over PH5,PH6,PE4,PE5,PG5,PE3,PH3,PH4, WR on PF1
+  if (this == &PORTH || this == &PORTE || this == &PORTG)
+    dataStores++;
+  if (this == &PORTF && !(old & 2) && (n & 2))
+  {
+    strobes++;
+    uint8_t b = ((PORTH.v & (3 << 5)) >> 5) | ((PORTE.v & (3 << 4)) >> 2) | ((PORTG.v & (1 << 5)) >> 1)
+              | ((PORTE.v & (1 << 3)) << 2) | ((PORTH.v & (3 << 3)) << 3);
+    if (!haveHigh)
+      highByte = b;
+    else
+      latched.push_back((highByte << 8) | b);
+    haveHigh = !haveHigh;
+  }
+#endif
+}
+
+unsigned long millis() { return 0; }
+void delay(unsigned long) {}
+
+static int fails;
+
+static void reset()
+{
+  latched.clear();
+  strobes = dataStores = 0;
+  haveHigh = false;
+  PORTF.v = 0xFF;
+  PORTG.v = 0xFF;
+}
+
+static void expect(const char* what, const std::vector<uint16_t>& want)
+{
+  bool ok = latched == want && strobes == (long)want.size() * (BUS16 ? 1 : 2) && !haveHigh;
+  if (!ok)
+    fails++;
+  printf("%-24s %s pixels %4zu strobes %5ld data-port stores %5ld\n", what, ok ? "ok  " : "FAIL",
+         latched.size(), strobes, dataStores);
+}
+
+int main()
+{
+  // only the bus kernels run, so the object needs no constructor
+  MCUFRIEND_kbv* tft = (MCUFRIEND_kbv*)calloc(1, sizeof(MCUFRIEND_kbv));
+  char what[40];
+
+  const uint16_t colors[] = {0x0000, 0xFFFF, 0xC618, 0x8410, 0x0010};
+  const uint16_t runs[] = {1, 7, 8, 9, 298, 320};
+  for (uint16_t c : colors)
+    for (uint16_t n : runs)
+    {
+      reset();
+      PORTH.v = 0x81;   // bits that are not data lines must survive
+      PORTE.v = 0x03;
+      PORTG.v |= 0x08;
+      tft->pushRun(c, n, false);
+      snprintf(what, sizeof what, "pushRun %04X x%u", c, n);
+      expect(what, std::vector<uint16_t>(n, c));
+#if !BUS16
+      if ((PORTH.v & 0x87) != 0x81 || (PORTE.v & 0xC7) != 0x03)
+      {
+        printf("  other port bits lost\n");
+        fails++;
+      }
+#endif
+    }
+
+  // an 8x16 cell as Ui::printText() builds it
+  uint8_t cell[16];
+  for (int i = 0; i < 16; i++)
+    cell[i] = (i < 3 || i > 13) ? 0 : (uint8_t)(0x3C ^ (i * 0x11));
+  const uint16_t pairs[][2] = {{0x0000, 0xC618}, {0xFFFF, 0x0010}, {0x0000, 0xFFFF}, {0xFFFF, 0xFFFF}};
+  for (auto& pair : pairs)
+  {
+    std::vector<uint16_t> want;
+    for (int i = 0; i < 128; i++)
+      want.push_back((cell[i / 8] & (0x80 >> (i & 7))) ? pair[0] : pair[1]);
+    reset();
+    tft->pushBits(cell, 128, pair[0], pair[1], false);
+    snprintf(what, sizeof what, "pushBits %04X/%04X", pair[0], pair[1]);
+    expect(what, want);
+  }
+
+  printf(fails ? "FAILED %d\n" : "all ok\n", fails);
+  return fails != 0;
+}
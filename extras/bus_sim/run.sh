@@ -0,0 +1,18 @@
+#!/bin/sh
+# Builds and runs bus_sim.cpp for the 16-bit Mega shield and for an 8-bit Uno shield.
+# The 8-bit run uses a copy of the library with USE_MEGA_16BIT_SHIELD turned off.
+set -e
+cd "$(dirname "$0")"
+lib=../../src/MCUFRIEND_kbv
+out=${TMPDIR:-/tmp}/bus_sim.$$
+mkdir -p "$out"
+trap 'rm -rf "$out"' EXIT
+cp -r "$lib" "$out/lib8"
+sed -i 's|^#define USE_MEGA_16BIT_SHIELD|//#define USE_MEGA_16BIT_SHIELD|' "$out/lib8/utility/mcufriend_special.h"
+flags="-std=gnu++11 -O1 -w -fpermissive -Istub -D__AVR__ -D__AVR_ATmega2560__ -DARDUINO_AVR_MEGA2560 -DARDUINO=10800"
+echo "== 16-bit shield"
+g++ $flags -DBUS16=1 -I$lib bus_sim.cpp $lib/MCUFRIEND_kbv.cpp -o "$out/sim16"
+"$out/sim16"
+echo "== 8-bit shield"
+g++ $flags -DBUS16=0 -I"$out/lib8" bus_sim.cpp "$out/lib8/MCUFRIEND_kbv.cpp" -o "$out/sim8"
+"$out/sim8"
@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+typedef struct { uint16_t bitmapOffset; uint8_t width, height, xAdvance; int8_t xOffset, yOffset; } GFXglyph;
+typedef struct { const uint8_t* bitmap; const GFXglyph* glyph; uint16_t first, last; uint8_t yAdvance; } GFXfont;
+class Adafruit_GFX : public Print
+{
+public:
+  Adafruit_GFX(int16_t, int16_t) {}
+  virtual void drawPixel(int16_t, int16_t, uint16_t) = 0;
+  virtual void fillRect(int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+  virtual void drawFastVLine(int16_t, int16_t, int16_t, uint16_t) {}
+  virtual void drawFastHLine(int16_t, int16_t, int16_t, uint16_t) {}
+  virtual void fillScreen(uint16_t) {}
+  virtual void setRotation(uint8_t) {}
+  virtual void invertDisplay(bool) {}
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+  uint8_t getRotation() const { return rotation; }
+protected:
+  const int16_t WIDTH = 240, HEIGHT = 320;
+  int16_t _width = 320, _height = 240, cursor_x, cursor_y;
+  uint16_t textcolor, textbgcolor;
+  uint8_t rotation;
+  GFXfont* gfxFont;
+};
@@ -0,0 +1,28 @@
+// just enough of the Arduino core for MCUFRIEND_kbv.cpp to build on the host
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include "avr/pgmspace.h"
+#include "avr/io.h"
+typedef uint8_t byte;
+typedef bool boolean;
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define A0 54
+#define A1 55
+#define A2 56
+#define A3 57
+#define A4 58
+#define F_CPU 16000000UL
+unsigned long millis();
+void delay(unsigned long);
+inline void delayMicroseconds(unsigned int) {}
+inline void yield() {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return 0; }
+class Print { public: virtual size_t write(uint8_t) { return 1; } virtual ~Print() {} };
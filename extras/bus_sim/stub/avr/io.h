@@ -0,0 +1,48 @@
+// the Mega2560 GPIO ports as seen by the bus simulation: every store goes through Port::set()
+#pragma once
+#include <stdint.h>
+#include <vector>
+struct Port
+{
+  uint8_t v;
+  void set(uint8_t n);
+  Port& operator=(uint8_t n) { set(n); return *this; }
+  Port& operator&=(uint8_t n) { set(v & n); return *this; }
+  Port& operator|=(uint8_t n) { set(v | n); return *this; }
+  operator uint8_t() const { return v; }
+};
+extern Port ports[33];
+#define PINA ports[0]
+#define DDRA ports[1]
+#define PORTA ports[2]
+#define PINB ports[3]
+#define DDRB ports[4]
+#define PORTB ports[5]
+#define PINC ports[6]
+#define DDRC ports[7]
+#define PORTC ports[8]
+#define PIND ports[9]
+#define DDRD ports[10]
+#define PORTD ports[11]
+#define PINE ports[12]
+#define DDRE ports[13]
+#define PORTE ports[14]
+#define PINF ports[15]
+#define DDRF ports[16]
+#define PORTF ports[17]
+#define PING ports[18]
+#define DDRG ports[19]
+#define PORTG ports[20]
+#define PINH ports[21]
+#define DDRH ports[22]
+#define PORTH ports[23]
+#define PINJ ports[24]
+#define DDRJ ports[25]
+#define PORTJ ports[26]
+#define PINK ports[27]
+#define DDRK ports[28]
+#define PORTK ports[29]
+#define PINL ports[30]
+#define DDRL ports[31]
+#define PORTL ports[32]
+#define _BV(b) (1 << (b))
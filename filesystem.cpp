@@ -8,7 +8,10 @@
 
 // A: to D:
 bool imageMounted[] = {false, false, false, false};
-char imagePath[4][MAX_PATH+1] = {0};
+bool imagePending[] = {false, false, false, false};  // registered (counts as mounted), opened on first access
+bool imageReadOnly[] = {false, false, false, false};
+ImageLocator imageLocator[4] = {0};
+const char* imagePath[4] = {NULL, NULL, NULL, NULL}; // registered by path, resolved on first access
 File files[4];
 
 bool fsIsDriveMounted(BYTE drive)
@@ -21,20 +24,31 @@ bool fsIsDriveMounted(BYTE drive)
   return imageMounted[drive];
 }
 
-bool fsIsFileNameInUse(const char* fileName)
+bool fsIsDrivePending(BYTE drive)
 {
-  if (!fileName || !mountedDrives)
+  if (drive > 3)
+  {
+    return false;
+  }
+  
+  return imagePending[drive];
+}
+
+bool fsIsImageInUse(const ImageLocator& locator)
+{
+  // the same directory entry chain is the same file, regardless of the case of its name
+  if (!locator.depth || !mountedDrives)
   {
     return false;
   }
   
   for (BYTE index = 0; index < sizeof(imageMounted); index++)
   {
-    if (!imageMounted[index])
+    if (!imageMounted[index] || (imageLocator[index].depth != locator.depth))
     {
       continue;
     }
-    if (strcmp(imagePath[index], fileName) == 0)
+    if (memcmp(imageLocator[index].index, locator.index, locator.depth * sizeof(WORD)) == 0)
     {
       return true;
     }
@@ -43,8 +57,282 @@ bool fsIsFileNameInUse(const char* fileName)
   return false;
 }
 
-bool fsMount(BYTE drive, BYTE& progmemResult, bool readOnly)
+// directories resolved recently, by a hash of their path; least recently used replaced
+// a hit is checked by name against the path by fsOpenLocator(), as two paths may share the hash,
+// a directory deleted and recreated since fails its first sector check
+#define FS_PATH_CACHE 4
+struct PathCacheEntry
+{
+  WORD hash;                // CRC16 of the path, case-insensitive, without a trailing slash
+  WORD length;
+  DWORD used;               // millis(), 0: free
+  ImageLocator locator;
+};
+PathCacheEntry pathCache[FS_PATH_CACHE];
+
+void fsPathCacheReset()
+{
+  // card (re)inserted
+  memset(pathCache, 0, sizeof(pathCache));
+}
+
+BYTE fsPathCacheFind(WORD hash, WORD length)
+{
+  for (BYTE slot = 0; slot < FS_PATH_CACHE; slot++)
+  {
+    if (pathCache[slot].used && (pathCache[slot].length == length) && (pathCache[slot].hash == hash))
+    {
+      return slot;
+    }
+  }
+  
+  return FS_PATH_CACHE;
+}
+
+void fsPathCacheStore(WORD hash, WORD length, const ImageLocator& locator)
+{
+  BYTE slot = fsPathCacheFind(hash, length);
+  if (slot == FS_PATH_CACHE)
+  {
+    slot = 0;
+    for (BYTE index = 1; index < FS_PATH_CACHE; index++)
+    {
+      if (pathCache[index].used < pathCache[slot].used)
+      {
+        slot = index;
+      }
+    }
+  }
+  
+  pathCache[slot].hash = hash;
+  pathCache[slot].length = length;
+  pathCache[slot].used = millis() | 1;
+  pathCache[slot].locator = locator;
+}
+
+bool fsOpenPath(const char* path, ImageLocator& locator, File& file, int openFlags, BYTE& progmemResult)
 {
+  // walks the path from the root, or from the longest cached directory on it,
+  // recording the directory entry index of each component; the last one is opened with openFlags
+  progmemResult = Progmem::uiErrorFileOpen;
+  locator.depth = 0;
+  locator.sector = 0;
+  
+  if (!path)
+  {
+    return false;
+  }
+  
+  // directory contents change
+  if (openFlags & O_CREAT)
+  {
+    fsPathCacheReset();
+  }
+  
+  // hashes of the path and of its parent directory, the longest cached prefix
+  const WORD pathLength = strlen(path);
+  WORD hash = 0xFFFF;
+  WORD dirHash[2] = {0};    // [0]: parent directory, [1]: the path itself
+  WORD dirLength[2] = {0};
+  WORD from = 0;
+  BYTE slot = FS_PATH_CACHE;
+  for (WORD index = 0; index <= pathLength; index++)
+  {
+    if ((index == pathLength) || (path[index] == '/'))
+    {
+      if (index && (path[index-1] != '/'))
+      {
+        dirHash[0] = dirHash[1];
+        dirLength[0] = dirLength[1];
+        dirHash[1] = hash;
+        dirLength[1] = index;
+        
+        const BYTE cached = fsPathCacheFind(hash, index);
+        if (cached != FS_PATH_CACHE)
+        {
+          from = index;
+          slot = cached;
+        }
+      }
+      
+      if (index == pathLength)
+      {
+        break;
+      }
+    }
+    hash = _crc16_update(hash, tolower(path[index]));
+  }
+  
+  File dir;
+  char name[MAX_PATH + 1];
+  if (slot != FS_PATH_CACHE)
+  {
+    pathCache[slot].used = millis() | 1;
+    locator = pathCache[slot].locator;
+    if (!fsOpenLocator(locator, dir, (from == pathLength) ? openFlags : O_RDONLY, path, from, name))
+    {
+      pathCache[slot].used = 0;
+      locator.depth = 0;
+      from = 0;
+    }
+    locator.sector = 0;
+  }
+  if (!from)
+  {
+    dir = sd.open("/", O_RDONLY);
+  }
+  if (!dir)
+  {
+    return false;
+  }
+  
+  path += from;
+  DWORD parentSector = 0;
+  while (*path)
+  {
+    const char* end = strchr(path, '/');
+    const WORD length = end ? (end - path) : strlen(path);
+    if (!length) // leading or double slash
+    {
+      path++;
+      continue;
+    }
+    
+    if (locator.depth == MAX_DEPTH)
+    {
+      progmemResult = Progmem::uiErrorPath;
+      return false;
+    }
+    
+    memcpy(name, path, length);
+    name[length] = 0;
+    path += length;
+    
+    const bool last = !*path || !path[1];
+    File next;
+    if (!next.open(&dir, name, last ? openFlags : O_RDONLY))
+    {
+      return false;
+    }
+    
+    locator.index[locator.depth++] = next.dirIndex();
+    parentSector = dir.firstSector();
+    dir = next;
+  }
+  
+  if (!locator.depth)
+  {
+    return false;
+  }
+  
+  // remember the directory, or the one the file is in
+  ImageLocator cached = locator;
+  cached.sector = dir.firstSector();
+  if (dir.isDir())
+  {
+    fsPathCacheStore(dirHash[1], dirLength[1], cached);
+  }
+  else if (parentSector && (locator.depth > 1))
+  {
+    cached.depth--;
+    cached.sector = parentSector;
+    fsPathCacheStore(dirHash[0], dirLength[0], cached);
+  }
+  
+  file = dir;
+  progmemResult = Progmem::Empty;
+  return true;
+}
+
+bool fsOpenDirectory(const char* path, File& dir)
+{
+  // full path of a directory, the root included
+  if (path && (strspn(path, "/") == strlen(path)))
+  {
+    dir = sd.open("/", O_RDONLY);
+    return dir;
+  }
+  
+  ImageLocator locator;
+  BYTE progmemResult;
+  if (!fsOpenPath(path, locator, dir, O_RDONLY, progmemResult))
+  {
+    return false;
+  }
+  if (!dir.isDir())
+  {
+    dir.close();
+    return false;
+  }
+  
+  return true;
+}
+
+bool fsOpenLocator(const ImageLocator& locator, File& file, int openFlags, const char* path, WORD length, char* name)
+{
+  // path optional: length characters of the path the locator should lead to, each level is checked by name
+  // name: MAX_PATH + 1 bytes for that
+  if (!locator.depth)
+  {
+    return false;
+  }
+  
+  const char* end = path + length;
+  File dir = sd.open("/", O_RDONLY);
+  for (BYTE level = 0; level < locator.depth; level++)
+  {
+    File next;
+    if (!dir || !next.open(&dir, locator.index[level], (level == locator.depth-1) ? openFlags : O_RDONLY))
+    {
+      return false;
+    }
+    dir = next;
+    
+    if (!path)
+    {
+      continue;
+    }
+    
+    // component of this level
+    while ((path < end) && (*path == '/'))
+    {
+      path++;
+    }
+    const char* slash = (const char*)memchr(path, '/', end - path);
+    const WORD nameLength = (slash ? slash : end) - path;
+    if (!nameLength || !dir.getName(name, MAX_PATH + 1) || (strlen(name) != nameLength) || (strncasecmp(name, path, nameLength) != 0))
+    {
+      dir.close();
+      return false;
+    }
+    path += nameLength;
+  }
+  
+  // as many levels as components
+  while (path && (path < end) && (*path == '/'))
+  {
+    path++;
+  }
+  if (path && (path != end))
+  {
+    dir.close();
+    return false;
+  }
+  
+  // something else there now (other card, recreated image)?
+  if (locator.sector && (dir.firstSector() != locator.sector))
+  {
+    dir.close();
+    return false;
+  }
+  
+  file = dir;
+  return true;
+}
+
+bool fsMount(BYTE drive, const char* path, BYTE& progmemResult, bool readOnly)
+{
+  // path NULL: (re)mount the image last mounted to this drive
   progmemResult = Progmem::Empty;
   if (drive > 3)
   {
@@ -54,17 +342,32 @@ bool fsMount(BYTE drive, BYTE& progmemResult, bool readOnly)
   bool& mount = imageMounted[drive];
   if (!mount)
   {
-    if (fsIsFileNameInUse(imagePath[drive]))
+    ImageLocator locator;
+    File& file = files[drive];
+    const int openFlags = readOnly ? O_RDONLY : O_RDWR;
+    
+    if (path)
     {
-      progmemResult = Progmem::uiErrorFileOpened;
-      return false;
+      if (!fsOpenPath(path, locator, file, openFlags, progmemResult))
+      {
+        return false;
+      }
+      locator.sector = file.firstSector();
+    }
+    else
+    {
+      locator = imageLocator[drive];
+      if (!fsOpenLocator(locator, file, openFlags))
+      {
+        progmemResult = Progmem::uiErrorFileOpen;
+        return false;
+      }
     }
     
-    File& file = files[drive];
-    file = sd.open(imagePath[drive], readOnly ? O_RDONLY : O_RDWR);
-    if (!file)
+    if (fsIsImageInUse(locator))
     {
-      progmemResult = Progmem::uiErrorFileOpen;
+      file.close();
+      progmemResult = Progmem::uiErrorFileOpened;
       return false;
     }
     
@@ -75,8 +378,15 @@ bool fsMount(BYTE drive, BYTE& progmemResult, bool readOnly)
       return false;
     }
     
+    if (path)
+    {
+      catAddImage(locator); // if not listed yet
+    }
+    
     file.rewind();  
     mount = true;
+    imageLocator[drive] = locator;
+    imageReadOnly[drive] = readOnly;
     mountedDrives++;
     return true;
   }
@@ -84,7 +394,71 @@ bool fsMount(BYTE drive, BYTE& progmemResult, bool readOnly)
   return true;
 }
 
-bool fsCreateAndMount(BYTE drive, BYTE& progmemResult)
+bool fsRegisterLocator(BYTE drive, const ImageLocator& locator, bool readOnly)
+{
+  // first stage of a lazy mount: only record the image locator and read-only flag,
+  // the image is opened and validated by fsOpenPending() on first access
+  if ((drive > 3) || imageMounted[drive] || !locator.depth || fsIsImageInUse(locator))
+  {
+    return false;
+  }
+  
+  imageMounted[drive] = true;
+  imagePending[drive] = true;
+  imageReadOnly[drive] = readOnly;
+  imageLocator[drive] = locator;
+  imagePath[drive] = NULL;
+  mountedDrives++;
+  return true;
+}
+
+bool fsRegister(BYTE drive, const char* path, bool readOnly)
+{
+  // path given: only checked to exist here, walked to a locator by fsOpenPending();
+  // the string is kept by the caller until then
+  if ((drive > 3) || imageMounted[drive] || !path || !sd.exists(path))
+  {
+    return false;
+  }
+  
+  imageMounted[drive] = true;
+  imagePending[drive] = true;
+  imageReadOnly[drive] = readOnly;
+  imageLocator[drive].depth = 0;
+  imagePath[drive] = path;
+  mountedDrives++;
+  return true;
+}
+
+bool fsOpenPending(BYTE drive)
+{
+  // second stage: open a registered image, unmount the drive if it is not there or invalid
+  if (drive > 3)
+  {
+    return false;
+  }
+  
+  if (!imagePending[drive])
+  {
+    return imageMounted[drive];
+  }
+  
+  imagePending[drive] = false;
+  imageMounted[drive] = false;
+  mountedDrives--;
+  
+  BYTE dummy;
+  const char* path = imagePath[drive];
+  imagePath[drive] = NULL;
+  if (!fsMount(drive, path, dummy, imageReadOnly[drive]))
+  {
+    return false; // journaled still, it may be on the next card
+  }
+  
+  return true;
+}
+
+bool fsCreateAndMount(BYTE drive, const char* path, BYTE& progmemResult)
 {
   progmemResult = Progmem::Empty;
   if (drive > 3)
@@ -95,24 +469,35 @@ bool fsCreateAndMount(BYTE drive, BYTE& progmemResult)
   bool& mount = imageMounted[drive];
   if (!mount)
   {
-    if (fsIsFileNameInUse(imagePath[drive]))
+    ImageLocator locator;
+    File& file = files[drive];
+    
+    // do not truncate an image mounted elsewhere
+    if (fsOpenPath(path, locator, file, O_RDONLY, progmemResult))
     {
-      progmemResult = Progmem::uiErrorFileOpened;
-      return false;
+      file.close();
+      if (fsIsImageInUse(locator))
+      {
+        progmemResult = Progmem::uiErrorFileOpened;
+        return false;
+      }
     }
     
-    progmemResult = Progmem::uiErrorFileCreate;
-    File& file = files[drive];
-    file = sd.open(imagePath[drive], O_RDWR | O_CREAT | O_TRUNC);
-    if (!file)
+    if (!fsOpenPath(path, locator, file, O_RDWR | O_CREAT | O_TRUNC, progmemResult))
     {
+      if (progmemResult == Progmem::uiErrorFileOpen)
+      {
+        progmemResult = Progmem::uiErrorFileCreate;
+      }
       return false;
     }
+    progmemResult = Progmem::uiErrorFileCreate;
     
     // create 360K image with E5 format fill
     const DWORD imageSize = 368640L;
-    const WORD bufSize = 1024;
-    BYTE* buf = new BYTE[bufSize];
+    const WORD bufSize = 512;
+    const WORD arenaMark = Arena::mark();
+    BYTE* buf = Arena::alloc<BYTE>(bufSize);
     if (!buf)
     {
       progmemResult = Progmem::uiErrorMemory;
@@ -126,19 +511,23 @@ bool fsCreateAndMount(BYTE drive, BYTE& progmemResult)
     {
       if (!file.write(buf, bufSize))
       {
-        delete[] buf;
+        Arena::release(arenaMark);
         file.close();
         return false;
       }      
       count--;
     }
     
-    delete[] buf;
+    Arena::release(arenaMark);
     file.sync();
     file.rewind();
     progmemResult = Progmem::Empty;
      
     mount = true;
+    locator.sector = file.firstSector();
+    catAddImage(locator);
+    imageLocator[drive] = locator;
+    imageReadOnly[drive] = false;
     mountedDrives++;
     return true;
   }
@@ -153,12 +542,20 @@ void fsUnmount(BYTE drive)
     return;
   }
   
+  // the locator is kept for a remount with fsMount(drive, NULL, ...)
   bool& mount = imageMounted[drive];
   if (mount)
   {
-    File& file = files[drive];
-    file.sync();
-    file.close();
+    // pending drive: nothing opened yet
+    if (!imagePending[drive])
+    {
+      File& file = files[drive];
+      file.sync();
+      file.close();
+    }
+    
+    imagePending[drive] = false;
+    imagePath[drive] = NULL;
     mount = false;
     mountedDrives--;
   }
@@ -175,14 +572,282 @@ void fsUnmountAll()
   }
 }
 
-char* fsGetImagePath(BYTE drive)
+bool fsGetImagePath(BYTE drive, char* path, WORD size)
 {
-  if (drive > 3)
+  // full path of the mounted image
+  if ((drive > 3) || !imageMounted[drive])
   {
-    return NULL;
+    return false;
   }
   
-  return &imagePath[drive][0];
+  // not walked yet
+  if (imagePath[drive])
+  {
+    if (!path || !size)
+    {
+      return false;
+    }
+    strncpy(path, imagePath[drive], size - 1);
+    path[size - 1] = 0;
+    return true;
+  }
+  
+  return fsGetLocatorPath(imageLocator[drive], path, size);
+}
+
+bool fsGetLocatorPath(const ImageLocator& locator, char* path, WORD size)
+{
+  // reconstructs the full path from a locator;
+  // false if the entry is not there, holds another file than the locator's first sector tells, or the path does not fit
+  if (!path || (size < 2))
+  {
+    return false;
+  }
+  
+  path[0] = '/';
+  path[1] = 0;
+  WORD length = 1;
+  
+  File dir = sd.open("/", O_RDONLY);
+  for (BYTE level = 0; level < locator.depth; level++)
+  {
+    File next;
+    if (!dir || !next.open(&dir, locator.index[level], O_RDONLY))
+    {
+      return false;
+    }
+    if ((level == locator.depth-1) && locator.sector && (next.firstSector() != locator.sector))
+    {
+      return false;
+    }
+    
+    // name, or the slash after it, does not fit
+    if ((length + 1 >= size) || !next.getName(&path[length], size - length))
+    {
+      path[0] = 0;
+      return false;
+    }
+    length += strlen(&path[length]);
+    
+    if (level < locator.depth-1)
+    {
+      if (length + 1 >= size)
+      {
+        path[0] = 0;
+        return false;
+      }
+      path[length++] = '/';
+      path[length] = 0;
+    }
+    dir = next;
+  }
+  
+  return true;
+}
+
+bool fsIsImageName(const char* name)
+{
+  // *.p32, case-insensitive
+  const WORD length = name ? strlen(name) : 0;
+  return (length > 4) && (strcasecmp(&name[length-4], ".p32") == 0);
+}
+
+BYTE fsRawLongNamePart(const BYTE* raw, char* part)
+{
+  // characters of a long name part, UCS-2 outside ASCII as ?
+  static const BYTE offsets[] PROGMEM = {1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30};
+  
+  BYTE length = 0;
+  for (; length < sizeof(offsets); length++)
+  {
+    const BYTE offset = pgm_read_byte(&offsets[length]);
+    if (!raw[offset] && !raw[offset+1]) // terminated
+    {
+      break;
+    }
+    part[length] = raw[offset+1] ? '?' : raw[offset];
+  }
+  
+  return length;
+}
+
+bool fsIsInternalEntry(File& dir, const BYTE* raw)
+{
+  // raw 8.3 name of our own files in the root: /PMD32.CAT, the sorted views /PMD32.SV0 to .SV9, /PMD32.TMP
+  if (!dir.isRoot() || (memcmp(raw, "PMD32   ", 8) != 0))
+  {
+    return false;
+  }
+  
+  return (memcmp(&raw[8], "CAT", 3) == 0) || (memcmp(&raw[8], "TMP", 3) == 0) ||
+         ((memcmp(&raw[8], "SV", 2) == 0) && isdigit(raw[10]));
+}
+
+bool fsIsInternalName(File& dir, const char* name, BYTE length)
+{
+  // the same by the long name, of length characters (exFAT)
+  if (!dir.isRoot() || (length != 9) || (strncasecmp(name, "PMD32.", 6) != 0))
+  {
+    return false;
+  }
+  
+  name += 6;
+  return (strncasecmp(name, "CAT", 3) == 0) || (strncasecmp(name, "TMP", 3) == 0) ||
+         ((strncasecmp(name, "SV", 2) == 0) && isdigit(name[2]));
+}
+
+bool fsReadExFatEntry(File& dir, RawDirEntry& entry) __attribute__((noinline)); // keeps its name buffer off the FAT path
+
+bool fsReadExFatEntry(File& dir, RawDirEntry& entry)
+{
+  // exFAT entry sets are not FAT records: the next one is opened by SdFat, the name read whole
+  const DWORD position = dir.curPosition();
+  
+  File file;
+  char name[MAX_PATH + 1];
+  if (!file.openNext(&dir, O_RDONLY) || !file.getName(name, sizeof(name)))
+  {
+    return false;
+  }
+  
+  strncpy(entry.shortName, name, sizeof(entry.shortName) - 1); // shortened, read again by fsGetRawEntryName()
+  entry.shortName[sizeof(entry.shortName) - 1] = 0;
+  
+  entry.index = file.dirIndex();
+  entry.position = position;
+  entry.isDirectory = file.isDir();
+  entry.isHidden = file.isHidden() || fsIsInternalName(dir, name, strlen(name));
+  entry.hasLongName = true;
+  entry.isImage = fsIsImageName(name);
+  file.close();
+  return true;
+}
+
+bool fsReadRawEntry(File& dir, RawDirEntry& entry)
+{
+  // next entry of an open directory, false: end of directory
+  // only the last 4 characters of a long name are kept, enough to tell *.p32
+  if (sd.fatType() == FAT_TYPE_EXFAT)
+  {
+    return fsReadExFatEntry(dir, entry);
+  }
+  
+  char tail[4];         // right-aligned
+  BYTE tailLength = 0;
+  bool longName = false;
+  bool longEnough = false;
+  BYTE checksum = 0;
+  
+  BYTE raw[32];
+  DWORD position = dir.curPosition();
+  while (dir.read(raw, sizeof(raw)) == sizeof(raw))
+  {
+    if (raw[0] == 0) // end of directory
+    {
+      return false;
+    }
+    
+    const BYTE attributes = raw[11];
+    if ((raw[0] != 0xE5) && ((attributes & 0x3F) == 0x0F)) // long name part, stored last part first
+    {
+      char part[13];
+      const BYTE length = fsRawLongNamePart(raw, part);
+      
+      if (raw[0] & 0x40)
+      {
+        longName = true;
+        longEnough = ((raw[0] & 0x1F) > 1) || (length > 4);
+        checksum = raw[13];
+        tailLength = 0;
+        entry.position = position;
+      }
+      
+      // prepend what is missing of the tail
+      for (BYTE index = length; longName && index && (tailLength < sizeof(tail)); index--)
+      {
+        tail[sizeof(tail) - ++tailLength] = part[index-1];
+      }
+      
+      position = dir.curPosition();
+      continue;
+    }
+    
+    // deleted, volume label, . or ..
+    if ((raw[0] == 0xE5) || (attributes & 0x08) || (raw[0] == '.'))
+    {
+      longName = false;
+      position = dir.curPosition();
+      continue;
+    }
+    
+    // long name parts belong to this entry
+    BYTE sum = 0;
+    for (BYTE index = 0; index < 11; index++)
+    {
+      sum = ((sum & 1) ? 0x80 : 0) + (sum >> 1) + raw[index];
+    }
+    if (!longName || (sum != checksum))
+    {
+      longName = false;
+      entry.position = position;
+    }
+    
+    // 8.3, lower case flags as set by Windows
+    BYTE length = 0;
+    for (BYTE index = 0; (index < 8) && (raw[index] != ' '); index++)
+    {
+      const char c = ((index == 0) && (raw[0] == 0x05)) ? 0xE5 : raw[index];
+      entry.shortName[length++] = (raw[12] & 0x08) ? tolower(c) : c;
+    }
+    if (raw[8] != ' ')
+    {
+      entry.shortName[length++] = '.';
+    }
+    for (BYTE index = 8; (index < 11) && (raw[index] != ' '); index++)
+    {
+      entry.shortName[length++] = (raw[12] & 0x10) ? tolower(raw[index]) : raw[index];
+    }
+    entry.shortName[length] = 0;
+    
+    entry.index = (dir.curPosition() / sizeof(raw)) - 1;
+    entry.isDirectory = attributes & 0x10;
+    entry.isHidden = (attributes & 0x02) || fsIsInternalEntry(dir, raw);
+    entry.hasLongName = longName;
+    entry.isImage = longName ? (longEnough && (tailLength == sizeof(tail)) && (strncasecmp(tail, ".p32", sizeof(tail)) == 0)) :
+                               ((raw[8] == 'P') && (raw[9] == '3') && (raw[10] == '2'));
+    return true;
+  }
+  
+  return false;
+}
+
+bool fsGetRawEntryName(File& dir, const RawDirEntry& entry, char* name, WORD size)
+{
+  // full name of an entry read by fsReadRawEntry(), the directory position is kept
+  // the short name if there is no long one, or if it cannot be read
+  if (!name || !size)
+  {
+    return false;
+  }
+  
+  bool result = false;
+  if (entry.hasLongName)
+  {
+    const DWORD position = dir.curPosition();
+    
+    File file;
+    result = file.open(&dir, entry.index, O_RDONLY) && file.getName(name, size);
+    file.close();
+    dir.seekSet(position);
+  }
+  
+  if (!result)
+  {
+    strncpy(name, entry.shortName, size - 1);
+    name[size - 1] = 0;
+  }
+  
+  return true;
 }
 
 File* fsGetFile(BYTE drive)
@@ -192,83 +857,423 @@ File* fsGetFile(BYTE drive)
     return NULL;
   }
   
+  // first access to a lazily mounted drive
+  fsOpenPending(drive);
   return &files[drive];
 }
 
+// EEPROM journal of mounted drives, written as a ring of slots for wear leveling
+//
+// slot (EEPROM_SLOT_SIZE bytes):
+// +0, 1:  sequence number, incremented for each slot written (mod 256); written last, commits the slot
+// +1, 1:  number of slots back to the first slot of the record (0: record starts here)
+// +2, ..: record data
+//
+// record (snapshot of all persisted drives, spans as many slots as needed):
+// +0, 1:  EEPROM_MAGIC
+// +1, 1:  number of drive entries
+// per entry: drive (bits 0-1), read-only (bit 7); locator depth; directory entry indexes (WORD each); first sector (DWORD)
+// +n, 2:  CRC16 of all the above
+//
+// the newest slot is found by a binary search over the sequence numbers,
+// so a boot reads only a couple of slot headers plus the record itself
+
+#define EEPROM_SLOTS      64
+#define EEPROM_SLOT_SIZE  32
+#define EEPROM_SLOT_DATA  (EEPROM_SLOT_SIZE - 2)
+#define EEPROM_MAGIC      0x32
+
+BYTE eepromDrives = 0;      // bitmask of drives to persist
+BYTE eepromReadOnly = 0;    // bitmask
+ImageLocator eepromLocator[4]; // as persisted: kept over card removals, ejects and mounts by the host
+bool eepromKnown = false;   // the above loaded or changed since powerup, newer than a record being written
+BYTE eepromWriting = 0;     // bitmask of drives in the record being written, bit 7: write in progress
+bool eepromDirty = false;   // start a new record
+BYTE eepromNewest = 0;      // newest committed slot
+BYTE eepromSeq = 0;         // and its sequence number
+BYTE eepromStart = 0;       // first slot of the record being written
+WORD eepromPos = 0;         // next byte of the record being written
+WORD eepromLength = 0;      // record length incl. CRC
+WORD eepromCRC = 0;
+
+WORD fsEEPROMAddress(BYTE startSlot, WORD pos)
+{
+  const BYTE slot = (startSlot + (pos / EEPROM_SLOT_DATA)) % EEPROM_SLOTS;
+  return ((WORD)slot * EEPROM_SLOT_SIZE) + 2 + (pos % EEPROM_SLOT_DATA);
+}
+
+BYTE fsEEPROMRecordByte(WORD pos)
+{
+  // byte at pos of the record being written, generated from the mounted drives
+  if (pos == 0)
+  {
+    return EEPROM_MAGIC;
+  }
+  
+  WORD at = 2;
+  BYTE count = 0;
+  for (BYTE drive = 0; drive < 4; drive++)
+  {
+    if (!(eepromWriting & (1 << drive)))
+    {
+      continue;
+    }
+    count++;
+    
+    if (pos == 1)
+    {
+      continue;
+    }
+    
+    const ImageLocator& locator = eepromLocator[drive];
+    const BYTE length = locator.depth * sizeof(WORD);
+    if (pos == at)
+    {
+      return drive | ((eepromReadOnly & (1 << drive)) ? 0x80 : 0);
+    }
+    if (pos == at + 1)
+    {
+      return locator.depth;
+    }
+    if (pos < at + 2 + length)
+    {
+      return ((const BYTE*)locator.index)[pos - at - 2];
+    }
+    if (pos < at + 2 + length + sizeof(DWORD))
+    {
+      return ((const BYTE*)&locator.sector)[pos - at - 2 - length];
+    }
+    at += 2 + length + sizeof(DWORD);
+  }
+  
+  if (pos == 1)
+  {
+    return count;
+  }
+  
+  // CRC of everything before, low byte first
+  return (pos == at) ? (eepromCRC & 0xFF) : (eepromCRC >> 8);
+}
+
 void fsStoreDriveToEEPROM(BYTE drive)
 {
 #ifdef EEPROM_IMAGE_AUTOMOUNT
-   
-  // structure (index, size in bytes: description)
-  // +0, 1:          is drive mounted (0 false, 1 normal, 2 readonly)
-  // +1, 1:          8-bit checksum of the whole path buffer
-  // +2, MAX_PATH+1: path incl. terminating null
   
   if (drive > 3)
   {
     return;
-  }  
+  }
   
-  WORD offset = (WORD)drive * (MAX_PATH+3);  
-  EEPROM.update(offset++, imageMounted[drive] ? (files[drive].isWritable() ? 1 : 2) : 0);
-  if (!imageMounted[drive])  
+  // remember or forget this drive as the user mounted or unmounted it;
+  // the record, with the other drives as they were persisted, is written in the background by fsProcessEEPROM()
+  if (imageMounted[drive] && imageLocator[drive].depth)
   {
-    return;
+    eepromDrives |= (1 << drive);
+    eepromLocator[drive] = imageLocator[drive];
+    if (imageReadOnly[drive])
+    {
+      eepromReadOnly |= (1 << drive);
+    }
+    else
+    {
+      eepromReadOnly &= ~(1 << drive);
+    }
   }
-  
-  ui->messageBox(Progmem::uiUpdatingEEPROM, Progmem::uiBusy, false);
-  BYTE checkSum = 0;
-  const WORD checkSumOffset = offset++;
-  
-  for (WORD index = 0; index < sizeof(imagePath[drive]); index++)
+  else
   {
-    BYTE ch = (BYTE)imagePath[drive][index];
-    EEPROM.update(offset++, ch);
-    checkSum += ch;
-  }  
-  EEPROM.update(checkSumOffset, checkSum);
+    eepromDrives &= ~(1 << drive);
+  }
+  
+  eepromKnown = true;
+  eepromDirty = true;
   
 #endif // EEPROM_IMAGE_AUTOMOUNT
 }
 
-void fsAutoLoadImagesFromEEPROM()
+void fsProcessEEPROM()
 {
 #ifdef EEPROM_IMAGE_AUTOMOUNT
 
-  ui->messageBox(Progmem::uiLoadingEEPROM, Progmem::uiBusy, false);
+  // one EEPROM byte write per call at most, never waits for the previous write to complete
+  if (!eeprom_is_ready())
+  {
+    return;
+  }
+  
+  if (eepromDirty)
+  {
+    // (re)start a new record right after the newest slot
+    eepromDirty = false;
+    eepromWriting = 0x80 | eepromDrives;
+    eepromStart = (eepromNewest + 1) % EEPROM_SLOTS;
+    eepromPos = 0;
+    eepromCRC = 0xFFFF;
+    
+    eepromLength = 4;
+    for (BYTE drive = 0; drive < 4; drive++)
+    {
+      if (eepromDrives & (1 << drive))
+      {
+        eepromLength += 2 + (eepromLocator[drive].depth * sizeof(WORD)) + sizeof(DWORD);
+      }
+    }
+  }
+  
+  if (!eepromWriting)
+  {
+    return;
+  }
+  
+  // skip over bytes already holding the right value
+  while (eepromPos < eepromLength)
+  {
+    const WORD pos = eepromPos;
+    const BYTE data = fsEEPROMRecordByte(pos);
+    if (pos < eepromLength - 2)
+    {
+      eepromCRC = _crc16_update(eepromCRC, data);
+    }
+    eepromPos++;
+    
+    const WORD address = fsEEPROMAddress(eepromStart, pos);
+    const bool written = EEPROM.read(address) != data;
+    if (written)
+    {
+      EEPROM.write(address, data);
+    }
+    
+    // slot data complete, header follows
+    if (((pos % EEPROM_SLOT_DATA) == (EEPROM_SLOT_DATA - 1)) || (eepromPos == eepromLength))
+    {
+      eepromPos |= 0x8000;
+      return;
+    }
+    if (written)
+    {
+      return;
+    }
+  }
   
+  // slot header: back offset, then sequence number to commit
+  const WORD pos = (eepromPos & 0x7FFF) - 1;
+  const BYTE back = pos / EEPROM_SLOT_DATA;
+  const BYTE slot = (eepromStart + back) % EEPROM_SLOTS;
+  const WORD header = (WORD)slot * EEPROM_SLOT_SIZE;
+  
+  if (EEPROM.read(header + 1) != back)
+  {
+    EEPROM.write(header + 1, back);
+    return;
+  }
+  
+  eepromSeq++;
+  eepromNewest = slot;
+  EEPROM.update(header, eepromSeq);
+  eepromPos &= 0x7FFF;
+  
+  if (eepromPos == eepromLength)
+  {
+    eepromWriting = 0; // record complete
+  }
+  
+#endif // EEPROM_IMAGE_AUTOMOUNT
+}
+
+void fsMigrateEEPROM() __attribute__((noinline)); // keeps its path buffer off the boot path when there is a record
+
+void fsMigrateEEPROM()
+{
+  // no journal record: take over the drives stored by the layout before the journal, once;
+  // the record then written over it replaces it
+  //
+  // per drive, at drive * (MAX_PATH+3):
+  // +0, 1:          is drive mounted (0 false, 1 normal, 2 readonly)
+  // +1, 1:          8-bit checksum of the whole path buffer
+  // +2, MAX_PATH+1: path incl. terminating null
+  char path[MAX_PATH + 1];
   for (BYTE drive = 0; drive < 4; drive++)
   {
     WORD offset = (WORD)drive * (MAX_PATH+3);
     const BYTE mounted = EEPROM.read(offset++);
     if (!mounted || (mounted > 2))
     {
-      // not mounted or invalid
       continue;
     }
-       
+    
     const BYTE checkSum = EEPROM.read(offset++);
     BYTE calculated = 0;
-    for (WORD index = 0; index < sizeof(imagePath[drive]); index++)
+    for (WORD index = 0; index < sizeof(path); index++)
     {
-      const BYTE ch = EEPROM.read(offset++);      
-      calculated += ch;
-      imagePath[drive][index] = ch;
+      path[index] = EEPROM.read(offset++);
+      calculated += (BYTE)path[index];
     }
-            
-    // invalid or path not existent
-    if ((checkSum != calculated) || !sd.exists(imagePath[drive]))
+    
+    // invalid, or the image is not on this card: dropped, as before
+    ImageLocator locator;
+    File file;
+    BYTE dummy;
+    if ((checkSum != calculated) || path[MAX_PATH] || !fsOpenPath(path, locator, file, O_RDONLY, dummy))
     {
-      imagePath[drive][0] = 0;
       continue;
-    }   
+    }
+    file.close();
     
-    // try to mount, dismiss errors
-    BYTE dummy;
-    fsMount(drive, dummy, mounted == 2); // readonly?
+    eepromDrives |= (1 << drive);
+    eepromLocator[drive] = locator;
+    if (mounted == 2)
+    {
+      eepromReadOnly |= (1 << drive);
+    }
+  }
+  
+  if (eepromDrives)
+  {
+    eepromDirty = true;
+  }
+}
+
+void fsAutoLoadImagesFromEEPROM(BYTE firstDrive, BYTE lastDrive)
+{
+#ifdef EEPROM_IMAGE_AUTOMOUNT
+
+  // register only the drives not mounted yet, opened on first access or when idle;
+  // a missing image, or one on another card, unmounts itself then, but stays persisted
+  if (eepromKnown)
+  {
+    for (BYTE drive = firstDrive; (drive <= lastDrive) && (drive < 4); drive++)
+    {
+      if (eepromDrives & (1 << drive))
+      {
+        fsRegisterLocator(drive, eepromLocator[drive], eepromReadOnly & (1 << drive));
+      }
+    }
+    return;
+  }
+  eepromKnown = true;
+  
+  // newest slot: sequence numbers run up by one from slot 0 until the ring wraps over older slots
+  const BYTE first = EEPROM.read(0);
+  BYTE low = 0;
+  BYTE high = EEPROM_SLOTS - 1;
+  while (low < high)
+  {
+    const BYTE mid = (low + high + 1) / 2;
+    if ((BYTE)(EEPROM.read((WORD)mid * EEPROM_SLOT_SIZE) - first) == mid)
+    {
+      low = mid;
+    }
+    else
+    {
+      high = mid - 1;
+    }
+  }
+  
+  // writer continues after the newest slot
+  if (!eepromWriting)
+  {
+    eepromNewest = low;
+    eepromSeq = EEPROM.read((WORD)low * EEPROM_SLOT_SIZE);
+  }
+  
+  // newest record, or the one before if it was not completely written (up to 4 tries)
+  BYTE last = low;
+  for (BYTE attempt = 0; attempt < 4; attempt++)
+  {
+    const BYTE back = EEPROM.read(((WORD)last * EEPROM_SLOT_SIZE) + 1);
+    if (back >= EEPROM_SLOTS)
+    {
+      break; // erased or old format
+    }
+    const BYTE start = (last + EEPROM_SLOTS - back) % EEPROM_SLOTS;
+    
+    WORD crc = 0xFFFF;
+    WORD pos = 0;
+    BYTE data = EEPROM.read(fsEEPROMAddress(start, pos++));
+    crc = _crc16_update(crc, data);
+    BYTE count = EEPROM.read(fsEEPROMAddress(start, pos++));
+    crc = _crc16_update(crc, count);
+    
+    BYTE found = 0;
+    BYTE readOnly = 0;
+    ImageLocator loaded[4];
+    bool valid = (data == EEPROM_MAGIC) && (count <= 4);
+    while (valid && count--)
+    {
+      const BYTE flags = EEPROM.read(fsEEPROMAddress(start, pos++));
+      const BYTE depth = EEPROM.read(fsEEPROMAddress(start, pos++));
+      crc = _crc16_update(crc, flags);
+      crc = _crc16_update(crc, depth);
+      if (!depth || (depth > MAX_DEPTH))
+      {
+        valid = false;
+        break;
+      }
+      
+      // directory entry indexes, first sector
+      const BYTE drive = flags & 3;
+      ImageLocator& locator = loaded[drive];
+      locator.depth = depth;
+      const BYTE length = depth * sizeof(WORD);
+      for (BYTE index = 0; index < length + sizeof(DWORD); index++)
+      {
+        data = EEPROM.read(fsEEPROMAddress(start, pos++));
+        crc = _crc16_update(crc, data);
+        if (index < length)
+        {
+          ((BYTE*)locator.index)[index] = data;
+        }
+        else
+        {
+          ((BYTE*)&locator.sector)[index - length] = data;
+        }
+      }
+      
+      found |= (1 << drive);
+      if (flags & 0x80)
+      {
+        readOnly |= (1 << drive);
+      }
+    }
+    
+    if (valid)
+    {
+      data = EEPROM.read(fsEEPROMAddress(start, pos++));
+      valid = (data == (crc & 0xFF)) && (EEPROM.read(fsEEPROMAddress(start, pos)) == (crc >> 8));
+    }
+    
+    // all drives of the record are kept, for the next records and the drives registered later
+    if (valid)
+    {
+      eepromDrives = found;
+      eepromReadOnly = readOnly;
+      memcpy(eepromLocator, loaded, sizeof(eepromLocator));
+      fsAutoLoadImagesFromEEPROM(firstDrive, lastDrive);
+      return;
+    }
+    
+    // slot before this record
+    last = (start + EEPROM_SLOTS - 1) % EEPROM_SLOTS;
+  }
+  
+  // no record: the ring restarts at slot 0, with a sequence number that none of the other slot headers
+  // happens to continue, so that the search above finds the new records over an erased or old layout
+  if (!eepromWriting)
+  {
+    BYTE seq = EEPROM.read(0);
+    for (BYTE slot = 1; slot < EEPROM_SLOTS; slot++)
+    {
+      if ((BYTE)(EEPROM.read((WORD)slot * EEPROM_SLOT_SIZE) - slot) == seq)
+      {
+        seq++;
+        slot = 0;
+      }
+    }
+    eepromNewest = EEPROM_SLOTS - 1;
+    eepromSeq = seq - 1;
   }
   
-  ui->clearScreen();
+  fsMigrateEEPROM();
+  fsAutoLoadImagesFromEEPROM(firstDrive, lastDrive);
   
 #endif // EEPROM_IMAGE_AUTOMOUNT
 }
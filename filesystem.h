@@ -4,15 +4,52 @@
 
 #pragma once
 
-#define MAX_PATH 255
+#define MAX_PATH  255
+#define MAX_DEPTH 8   // directory levels of a mounted image path, incl. the image itself
+
+// image identity: directory entry index of each path component, starting in the root
+// full path is reconstructed on demand by fsGetLocatorPath()
+struct ImageLocator
+{
+  BYTE depth;               // number of path components incl. the image, 0: none
+  WORD index[MAX_DEPTH];
+  DWORD sector;             // first sector of the image, 0: not known
+};
+
+// directory entry read raw, without opening the file or assembling its long name (FAT16/32;
+// exFAT entry sets are opened through SdFat instead), . and .. , volume labels and deleted entries are skipped,
+// our own files in the root are hidden
+struct RawDirEntry
+{
+  WORD index;               // directory entry index of the short name, for File::open(&dir, index, ...)
+  DWORD position;           // where the entry started, incl. its long name parts
+  bool isDirectory;
+  bool isHidden;
+  bool isImage;             // *.p32, by the tail of the long name, or by the 8.3 extension
+  bool hasLongName;
+  char shortName[8 + 1 + 3 + 1];
+};
 
 bool fsIsDriveMounted(BYTE drive);
-bool fsIsFileNameInUse(const char* fileName);
-bool fsMount(BYTE drive, BYTE& progmemResult, bool readOnly = false);
-bool fsCreateAndMount(BYTE drive, BYTE& progmemResult);
+bool fsIsDrivePending(BYTE drive);
+bool fsMount(BYTE drive, const char* path, BYTE& progmemResult, bool readOnly = false);
+bool fsCreateAndMount(BYTE drive, const char* path, BYTE& progmemResult);
+bool fsRegister(BYTE drive, const char* path, bool readOnly = false);
+bool fsOpenPending(BYTE drive);
 void fsUnmount(BYTE drive);
 void fsUnmountAll();
-char* fsGetImagePath(BYTE drive);
+bool fsGetImagePath(BYTE drive, char* path, WORD size);
+bool fsGetLocatorPath(const ImageLocator& locator, char* path, WORD size);
+bool fsOpenPath(const char* path, ImageLocator& locator, File& file, int openFlags, BYTE& progmemResult);
+bool fsOpenLocator(const ImageLocator& locator, File& file, int openFlags, const char* path = NULL, WORD length = 0, char* name = NULL);
+bool fsOpenDirectory(const char* path, File& dir);
+void fsPathCacheReset();
+bool fsIsImageName(const char* name);
+bool fsIsInternalEntry(File& dir, const BYTE* raw);
+bool fsIsInternalName(File& dir, const char* name, BYTE length);
+bool fsReadRawEntry(File& dir, RawDirEntry& entry);
+bool fsGetRawEntryName(File& dir, const RawDirEntry& entry, char* name, WORD size);
 File* fsGetFile(BYTE drive);
 void fsStoreDriveToEEPROM(BYTE drive);
-void fsAutoLoadImagesFromEEPROM();
\ No newline at end of file
+void fsProcessEEPROM();
+void fsAutoLoadImagesFromEEPROM(BYTE firstDrive = 0, BYTE lastDrive = 3);
\ No newline at end of file
@@ -11,37 +11,125 @@ PMD32 pmd;
 SdFat sd;
 
 BYTE cardStatus;         // 0: undefined, 1: no card, 2: unreadable card, 3: card ready, 4: asked to eject
-BYTE uiStatus;           // 0: idle, 1: mounting drives, 2: create new image
+BYTE uiStatus;           // 0: idle, 1: mounting drives, 2: create new image, 3: find image by name
 BYTE mountedDrives;      // number of drives mounted
 BYTE selectedDrive;      // 0 to 3 => A to D
+bool firstRun;           // card not yet brought up since powerup, auto-mount pending
+WORD bootTimes[4];       // ms since reset when the card, A:, display and the rest of the drives were ready
 
 BYTE filePickerSel;      // 1-based item index, 0: nothing selected
 BYTE filePickerPage;     // 1-based, current page
-BYTE filePickerPages;    // - || - , total pages
+BYTE filePickerPages;    // - || - , total pages, 0: still being counted
 char filePickerBuf[MAX_PATH + 1] = {0};
+char filePickerPath[MAX_PATH + 1] = {0}; // cwd of the file picker
 
-bool DetectCard(bool& firstRun);
+#define PICKER_INDEX_PAGES 64
+WORD filePickerIndex[PICKER_INDEX_PAGES]; // directory position of the first entry of each page, in 32-byte entries
+BYTE filePickerIndexed;                   // pages with a known position
+DWORD filePickerScanPos;                  // background page count: directory position
+DWORD filePickerScanCount;                //                        entries counted, incl. [.] or [..]
+
+bool filePickerCatalog;  // file picker lists catalog search hits instead of the cwd
+bool filePickerSorted;   // - || - , the sorted view of the cwd
+DirView filePickerView;
+bool filePickerViewWanted; // cwd listed in raw order until its view is built with the host idle
+WORD filePickerFirst;    // sorted catalog position of the first hit
+WORD filePickerHits;     // catalog hits, or directories and images in the sorted view
+char findPrefix[CATALOG_NAME_LEN + 1] = {0};
+const char findCharset[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_";
+BYTE findChar;           // index to findCharset, character to add next
+
+#ifdef UI_DASHBOARD
+#define DASHBOARD_ACTIVITY_MS 250  // drive indicators refreshed
+#define DASHBOARD_RATES_MS    1000 // rates taken over
+#define DASHBOARD_BUSY_MS     300  // drive indicator lit after an access
+PMD32::Stats dashboardLast;        // totals when the rates were taken
+DWORD dashboardRatesTime;
+DWORD dashboardActivityTime;
+WORD dashboardKB10;                // KB/s x10
+WORD dashboardCommands;            // per second
+BYTE dashboardHits;                // %, of the blocks accessed
+#endif
+
+BYTE InitCard();
+bool DetectCard();
+void AutoMount(bool driveA);
 void CardAndDriveDetails();
 void ProcessUI();
 void ProcessPMD32();
-void DoDrivePicker(Ui::Button* buttonRow, bool mount, bool create = false);
-void DoFilePicker(bool calculateTotalPages = false, BYTE convertSelToFileName = 0, bool* selIsDirectory = NULL);
+void ProcessPendingMounts();
+void DoDrivePicker(bool mount, bool create = false);
+void DoFilePicker(bool resetPages = false, BYTE convertSelToFileName = 0, bool* selIsDirectory = NULL);
+bool FilePickerNextEntry(File& dir, RawDirEntry& entry, bool& listed);
+void FilePickerIndexPage(DWORD count, DWORD position);
+bool FilePickerHasPage(WORD page);
+void ProcessFilePickerIndex();
+void ProcessFilePickerView();
+void DoFindPrompt(bool redrawWhole = true);
+void ProcessDashboard(bool whole = false);
 
-void setup()
+// set while the display initializes: its waits serve the host
+bool bootServing = false;
+
+void yield()
 {
-  ui = Ui::get();
+  // called by the core's delay() while it waits, and by the display driver's own waits
+  if (bootServing)
+  {
+    bootServing = false; // not from within a command
+    ProcessPMD32();
+    bootServing = true;
+  }
 }
 
-void loop()
+void setup()
 {
   cardStatus = 0;
   uiStatus = 0;
   mountedDrives = 0;
-  bool firstRun = true;
+  firstRun = true;
+  memset(bootTimes, 0, sizeof(bootTimes));
+  
+#ifdef PMD32_LATENCY
+  pmd.beginLatency();
+#endif
   
+  // host first: the PMD port is already set up by the PMD32 constructor,
+  // bring up the card and A: and answer the host before the display initializes
+  // (a PMD 85 powered on together with us would otherwise time out its first probe)
+  const bool cardReady = InitCard() == 3;
+  if (cardReady)
+  {
+    bootTimes[0] = millis();
+    AutoMount(true);
+    bootTimes[1] = millis();
+    ProcessPMD32();
+  }
+  
+  // display work deferred until now; the host is still answered in its reset and sleep-out waits
+  bootServing = cardReady;
+  ui = Ui::get();
+  bootServing = false;
+  bootTimes[2] = millis();
+  
+  if (cardReady)
+  {
+    AutoMount(false);
+    bootTimes[3] = millis();
+    catBegin();
+    dvBegin();
+    
+    firstRun = false;
+    cardStatus = 3;
+    CardAndDriveDetails();
+  }
+}
+
+void loop()
+{
   while(true)
   {   
-    if (!DetectCard(firstRun))
+    if (!DetectCard())
     {
       fsUnmountAll();
       uiStatus = 0;      
@@ -49,11 +137,52 @@ void loop()
     }
     
     ProcessPMD32();
+    pmd.processIdle();
     ProcessUI();    
+    ProcessPendingMounts();
+#ifdef UI_DASHBOARD
+    ProcessDashboard();
+#endif
+#ifdef PMD32_LATENCY
+    pmd.processSerial();
+#endif
+    
+    if ((uiStatus == 1) && ui->isFilePicking())
+    {
+      ProcessFilePickerIndex();
+      ProcessFilePickerView();
+    }
+    
+    catProcess(); // background image catalog indexing
+  }
+}
+
+BYTE InitCard()
+{
+  // returns new cardStatus: 1 no card, 2 unreadable card, 3 card ready
+  
+#ifndef SD_SOFTWARE_SPI
+  static SdSpiConfig cfg(SD_HWSPI_CS, USER_SPI_BEGIN);
+#else
+  static SoftSpiDriver<SD_SWSPI_MISO, SD_SWSPI_MOSI, SD_SWSPI_CLK> spi;
+  static SdSpiConfig cfg(SD_SWSPI_CS, USER_SPI_BEGIN, SD_SCK_MHZ(0), &spi);
+#endif
+
+  if (!sd.cardBegin(cfg) || !sd.card()->sectorCount())
+  {
+    return 1;
+  }
+  
+  if (!sd.volumeBegin())
+  {
+    sd.end();
+    return 2;
   }
+  
+  return 3;
 }
 
-bool DetectCard(bool& firstRun)
+bool DetectCard()
 { 
   DWORD ocr = 0;
   
@@ -64,7 +193,7 @@ bool DetectCard(bool& firstRun)
     if (!sd.card()->readOCR(&ocr) || !(ocr & 0x80000000))
     {
       ui->clearScreen();
-      ui->outText(Progmem::getString(Progmem::uiNoCardPresent), true, true);
+      ui->outText(Progmem::uiNoCardPresent, true, true);
       cardStatus = 1;   
       
       return false;
@@ -74,33 +203,22 @@ bool DetectCard(bool& firstRun)
   // init card and volume  
   if (cardStatus < 3)
   {
-    
-#ifndef SD_SOFTWARE_SPI
-    static SdSpiConfig cfg(SD_HWSPI_CS, USER_SPI_BEGIN);
-#else
-    static SoftSpiDriver<SD_SWSPI_MISO, SD_SWSPI_MOSI, SD_SWSPI_CLK> spi;
-    static SdSpiConfig cfg(SD_SWSPI_CS, USER_SPI_BEGIN, SD_SCK_MHZ(0), &spi);
-#endif
-
-    if ((sd.cardBegin(cfg)) && sd.card()->sectorCount())
-    {     
-      if (!sd.volumeBegin())
+    const BYTE status = InitCard();
+    if (status == 2)
+    {
+      if (cardStatus != 2)
       {
-        sd.end();
-        if (cardStatus != 2)
-        {
-          ui->outText(Progmem::getString(Progmem::uiUnsupportedFS), true, true, true);
-          cardStatus = 2;
-        }
-        
-        return false;
+        ui->outText(Progmem::uiUnsupportedFS, true, true, true);
+        cardStatus = 2;
       }
+      
+      return false;
     }
-    else
+    else if (status == 1)
     {
       if (cardStatus != 1)
       {
-        ui->outText(Progmem::getString(Progmem::uiNoCardPresent), true, true, true);
+        ui->outText(Progmem::uiNoCardPresent, true, true, true);
         cardStatus = 1;  
       }
       
@@ -114,7 +232,7 @@ bool DetectCard(bool& firstRun)
     if (!sd.card()->readOCR(&ocr) || !(ocr & 0x80000000))
     {
       // card now cannot be detected
-      ui->outText(Progmem::getString(Progmem::uiNoCardPresent), true, true, true);
+      ui->outText(Progmem::uiNoCardPresent, true, true, true);
       cardStatus = 1;
     }
     
@@ -125,23 +243,18 @@ bool DetectCard(bool& firstRun)
   // passed checks, card is now in
   if (cardStatus != 3)
   {   
+    fsPathCacheReset();
+    
+    // card was not present at powerup
     if (firstRun)
     {
-      fsAutoLoadImagesFromEEPROM(); // if built with, see config.h
-      
-      // if nothing was mounted to A: on first run, check and autoload system.p32
-      const char systemImage[] = "/system.p32";
-      
-      if (!fsIsDriveMounted(0) && sd.exists(systemImage))
-      {
-        BYTE dummyResult;
-        strcpy(fsGetImagePath(0), systemImage);
-        fsMount(0, dummyResult, true); // readonly
-      }
-      
+      AutoMount(true);
+      AutoMount(false);
       firstRun = false;
     }
 
+    catBegin();
+    dvBegin();
     CardAndDriveDetails();
     cardStatus = 3;
   }
@@ -149,6 +262,28 @@ bool DetectCard(bool& firstRun)
   return true;
 }
 
+void AutoMount(bool driveA)
+{
+  // driveA TRUE: A: only, as soon as the card is up, without touching the display
+  //        FALSE: B: to D:, once the UI is running
+  if (driveA)
+  {
+    fsAutoLoadImagesFromEEPROM(0, 0); // if built with, see config.h
+      
+    // if nothing was mounted to A: on first run, autoload system.p32 (if present, opened on first access)
+    static const char systemImage[] = "/system.p32";
+    
+    if (!fsIsDriveMounted(0))
+    {
+      fsRegister(0, systemImage, true); // readonly
+    }
+  }
+  else
+  {
+    fsAutoLoadImagesFromEEPROM(1, 3);
+  }
+}
+
 void CardAndDriveDetails()
 {
   // in powers of ten, as manufacturers of storage media always do...
@@ -167,42 +302,49 @@ void CardAndDriveDetails()
     break; // just microSD, don't distinguish between versions
   }
 
-  snprintf(Ui::m_stringBuffer, sizeof(Ui::m_stringBuffer)-1, Progmem::getString(Progmem::uiCardDetails),
-           (capacityMB > 999) ? capacityGB : (WORD)round(capacityMB),
-           (capacityMB > 999) ? "GB" : "MB",
-           sdType);
-  
   ui->outText("", true, true, true);
+#ifdef UI_DASHBOARD
+  ui->setCursorY(DISP_HEIGHT*0.24);
+#else
   ui->setCursorY(DISP_HEIGHT*0.43);
-  ui->outText(Ui::m_stringBuffer, true);
+#endif
+  ui->outText(UiText(Progmem::uiCardDetails,
+                     (capacityMB > 999) ? capacityGB : (WORD)round(capacityMB),
+                     (capacityMB > 999) ? "GB" : "MB",
+                     sdType), true);
   
-  snprintf(Ui::m_stringBuffer, sizeof(Ui::m_stringBuffer)-1, Progmem::getString(Progmem::uiMountedDrives), mountedDrives);
+#ifdef UI_DASHBOARD
+  ProcessDashboard(true);
+#else
   ui->setCursorY(DISP_HEIGHT*0.53);
-  ui->outText(Ui::m_stringBuffer, true);
+  ui->outText(UiText(Progmem::uiMountedDrives, mountedDrives), true);
+  
+#ifdef DEBUG_ARENA_USAGE
+  // transient buffers peak use
+  ui->setCursorY(DISP_HEIGHT*0.33);
+  ui->outText(UiText(Progmem::uiArenaUsage, Arena::highWater(), ARENA_SIZE), true);
+#endif
   
-  // draw and link buttons
-  ui->setCursorY(DISP_HEIGHT*0.77);
+  // boot phase timing, if the card was in at powerup
+  if (bootTimes[3])
+  {
+    ui->setCursorY(DISP_HEIGHT*0.65);
+    ui->outText(UiText(Progmem::uiBootTimes, bootTimes[0], bootTimes[1], bootTimes[2], bootTimes[3]), true);
+  }
+#endif
   
+  // draw and link buttons: Mount, Unmount, Create, Eject
   if (!mountedDrives)
   {
-    const Ui::Button buttonRow[] = { {Ui::ButtonAction::Mount, Progmem::btnMount}, 
-                                     {Ui::ButtonAction::Create, Progmem::btnCreate}, 
-                                     {Ui::ButtonAction::Eject, Progmem::btnEject} };
-    ui->outButtons(buttonRow, BUTTONS_COUNTOF(buttonRow), DISP_WIDTH/4.6, DISP_HEIGHT/7.5);
+    ui->outButtons(&Ui::m_barIdle, 0x0D); // no Unmount
   }
   else if (mountedDrives < 4)
   {
-    const Ui::Button buttonRow[] = { {Ui::ButtonAction::Mount, Progmem::btnMount}, 
-                                     {Ui::ButtonAction::Unmount, Progmem::btnUnmount},
-                                     {Ui::ButtonAction::Create, Progmem::btnCreate},
-                                     {Ui::ButtonAction::Eject, Progmem::btnEject} };
-    ui->outButtons(buttonRow, BUTTONS_COUNTOF(buttonRow), DISP_WIDTH/4.6, DISP_HEIGHT/7.5);
+    ui->outButtons(&Ui::m_barIdle);
   }
   else
   {
-    const Ui::Button buttonRow[] = { {Ui::ButtonAction::Unmount, Progmem::btnUnmount},
-                                     {Ui::ButtonAction::Eject, Progmem::btnEject} };
-    ui->outButtons(buttonRow, BUTTONS_COUNTOF(buttonRow), DISP_WIDTH/4.6, DISP_HEIGHT/7.5);
+    ui->outButtons(&Ui::m_barIdle, 0x0A); // Unmount, Eject
   }
 }
 
@@ -219,30 +361,20 @@ void ProcessUI()
   {
     if ((action == Ui::ButtonAction::Mount) || (action == Ui::ButtonAction::Create))
     {
-      Ui::Button* buttonRow = new Ui::Button[5 - mountedDrives]; // include "Back" button
-      if (buttonRow)
-      {
-        DoDrivePicker(buttonRow, true, (action == Ui::ButtonAction::Create));        
-        delete[] buttonRow;
-        
-        uiStatus = (action == Ui::ButtonAction::Create) ? 2 : 1;
-      }
+      filePickerCatalog = false;
+      DoDrivePicker(true, (action == Ui::ButtonAction::Create));        
+      uiStatus = (action == Ui::ButtonAction::Create) ? 2 : 1;
     }      
     else if (action == Ui::ButtonAction::Unmount)
     {
-      Ui::Button* buttonRow = new Ui::Button[mountedDrives + 1];
-      if (buttonRow)
-      {
-        DoDrivePicker(buttonRow, false);        
-        delete[] buttonRow;
-      }
+      DoDrivePicker(false);        
     }
     else if (action == Ui::ButtonAction::Eject) // eject card gracefully, unmount and flush files
     {
       fsUnmountAll();
       sd.end();
       ui->clearScreen();
-      ui->outText(Progmem::getString(Progmem::uiCardSafeToEject), true, true);
+      ui->outText(Progmem::uiCardSafeToEject, true, true);
       
       cardStatus = 4;
     }
@@ -264,11 +396,31 @@ void ProcessUI()
   
   else if (uiStatus == 1) // mounting
   {
+    const DWORD shownPage = filePickerPage;
     if ((action >= Ui::ButtonAction::DriveA) && (action <= Ui::ButtonAction::DriveD))
     {
       selectedDrive = (action - Ui::ButtonAction::DriveA);
-      strcpy(fsGetImagePath(selectedDrive), "/");      
-      DoFilePicker(true); // calc number of pages
+      
+      // search the catalog by name instead
+      if (filePickerCatalog)
+      {
+        findPrefix[0] = 0;
+        findChar = 0;
+        uiStatus = 3;
+        DoFindPrompt();
+        return;
+      }
+      
+      strcpy(filePickerPath, "/");      
+      DoFilePicker(true); // reset pages
+    }
+    
+    // same drive picker, asking for the drive to find an image for
+    else if (action == Ui::ButtonAction::Find)
+    {
+      filePickerCatalog = true;
+      DoDrivePicker(true);
+      return;
     }
     
     // file picker buttons
@@ -284,7 +436,7 @@ void ProcessUI()
     }
     else if (action == Ui::ButtonAction::PgDn)
     {
-      if (filePickerPage == filePickerPages)
+      if (!FilePickerHasPage(filePickerPage + 1))
       {
         return;
       }
@@ -321,7 +473,7 @@ void ProcessUI()
       if (filePickerSel == ui->getFilePickerCount())
       {
         // one page down
-        if (filePickerPage < filePickerPages)
+        if (FilePickerHasPage(filePickerPage + 1))
         {
           filePickerSel = 1;
           filePickerPage++;
@@ -338,12 +490,20 @@ void ProcessUI()
     }
     else if (action == Ui::ButtonAction::Open)
     {
-      char* path = fsGetImagePath(selectedDrive);      
-      if (!filePickerSel || !path)
+      char* path = filePickerPath;      
+      if (!filePickerSel)
       {
         return;
       }
       
+      // [..] of search hits, back to the search
+      if (filePickerCatalog && (filePickerSel == 1) && (filePickerPage == 1))
+      {
+        uiStatus = 3;
+        DoFindPrompt();
+        return;
+      }
+      
       const bool isRoot = strrchr(path, '/') == path;      
       if ((filePickerSel == 1) && (filePickerPage == 1)) // [.] or [..]
       {
@@ -363,7 +523,7 @@ void ProcessUI()
             lastSlash[1] = 0;                         // "/1" => "/"
           }
 
-          DoFilePicker(true);                         // update cwd and page count
+          DoFilePicker(true);                         // update cwd, reset pages
         }        
       }
       
@@ -373,12 +533,18 @@ void ProcessUI()
         bool isDirectory = false;      
         DoFilePicker(false, filePickerSel, &isDirectory);
         
+        // listing changed under the selection
+        if (!filePickerBuf[0])
+        {
+          DoFilePicker();
+          return;
+        }
+        
         if ((strlen(path) + strlen(filePickerBuf) + 1) > MAX_PATH)
         {
           ui->messageBox(Progmem::uiErrorPath, Progmem::uiError);
 
-          const Ui::Button buttonRow[] = { {Ui::ButtonAction::OK, Progmem::btnOK} };
-          ui->outButtons(buttonRow, BUTTONS_COUNTOF(buttonRow), DISP_WIDTH/3.5, DISP_HEIGHT/7.5);
+          ui->outButtons(&Ui::m_barOK);
           return;
         }
         
@@ -395,10 +561,7 @@ void ProcessUI()
         {
           ui->messageBox(Progmem::uiMountReadOnly, Progmem::uiMountCaption);
 
-          const Ui::Button buttonRow[] = { {Ui::ButtonAction::Yes, Progmem::btnYes},
-                                           {Ui::ButtonAction::No,  Progmem::btnNo},
-                                           {Ui::ButtonAction::Cancel,  Progmem::btnCancel} };
-          ui->outButtons(buttonRow, BUTTONS_COUNTOF(buttonRow), DISP_WIDTH/4, DISP_HEIGHT/7.5);
+          ui->outButtons(&Ui::m_barYesNoCancel);
           return;
         }        
       }
@@ -407,12 +570,12 @@ void ProcessUI()
     // image picked, Yes/No to mount as read only
     else if ((action == Ui::ButtonAction::Yes) || (action == Ui::ButtonAction::No))
     {
-      char* path = fsGetImagePath(selectedDrive); 
+      char* path = filePickerPath; 
       const BYTE oldLen = strlen(path); // in case the mount fails
       strcat(path, filePickerBuf);
       
       BYTE progmemResult = 0;
-      if (fsMount(selectedDrive, progmemResult, action == Ui::ButtonAction::Yes))
+      if (fsMount(selectedDrive, path, progmemResult, action == Ui::ButtonAction::Yes))
       {
         fsStoreDriveToEEPROM(selectedDrive); // if enabled
         
@@ -425,8 +588,7 @@ void ProcessUI()
       {
         ui->messageBox(progmemResult, Progmem::uiError);
 
-        const Ui::Button buttonRow[] = { {Ui::ButtonAction::OK, Progmem::btnOK} };
-        ui->outButtons(buttonRow, BUTTONS_COUNTOF(buttonRow), DISP_WIDTH/3.5, DISP_HEIGHT/7.5);
+        ui->outButtons(&Ui::m_barOK);
       }
       
       // strip filename from path before the file picker redraws
@@ -459,10 +621,93 @@ void ProcessUI()
       return;
     }
     
+    // highlight moved within the page: the two rows only, the directory is not read
+    if (((action == Ui::ButtonAction::Up) || (action == Ui::ButtonAction::Down) || (action == Ui::ButtonAction::FilePicked)) &&
+        (filePickerPage == shownPage) && ui->drawFilePickerSel(filePickerSel))
+    {
+      return;
+    }
+    
     // draw
     DoFilePicker();
   }
   
+  else if (uiStatus == 3) // finding image by name
+  {
+    const BYTE charsetLength = strlen(findCharset);
+    bool redrawWhole = false;
+    
+    if (action == Ui::ButtonAction::PrevChar)
+    {
+      findChar = (findChar + charsetLength - 1) % charsetLength;
+    }
+    else if (action == Ui::ButtonAction::NextChar)
+    {
+      findChar = (findChar + 1) % charsetLength;
+    }
+    else if (action == Ui::ButtonAction::AddChar)
+    {
+      const BYTE length = strlen(findPrefix);
+      if (length == CATALOG_NAME_LEN)
+      {
+        return;
+      }
+      
+      findPrefix[length] = findCharset[findChar];
+      findPrefix[length + 1] = 0;
+    }
+    else if (action == Ui::ButtonAction::DelChar)
+    {
+      const BYTE length = strlen(findPrefix);
+      if (!length)
+      {
+        return;
+      }
+      
+      findPrefix[length - 1] = 0;
+    }
+    
+    // list the hits in the file picker
+    else if (action == Ui::ButtonAction::Find)
+    {
+      filePickerFirst = catFind(findPrefix, filePickerHits);
+      if (!filePickerHits)
+      {
+        ui->messageBox(catIsIndexing() ? Progmem::uiFindIndexing : Progmem::uiFindNone, Progmem::uiFindCaption);
+        
+        ui->outButtons(&Ui::m_barOK);
+        return;
+      }
+      
+      filePickerPath[0] = 0; // hits are full paths
+      DoFilePicker(true);
+      DoFilePicker();
+      uiStatus = 1;
+      return;
+    }
+    
+    else if (action == Ui::ButtonAction::Back)
+    {
+      uiStatus = 0;
+      ui->clearScreen();
+      CardAndDriveDetails();
+      return;
+    }
+    
+    // message box dismissed
+    else if (action == Ui::ButtonAction::OK)
+    {
+      redrawWhole = true;
+    }
+    
+    else
+    {
+      return;
+    }
+    
+    DoFindPrompt(redrawWhole);
+  }
+  
   else if (uiStatus == 2) // creating new image
   {
     char fileName[] = "/driveX.p32";
@@ -473,12 +718,9 @@ void ProcessUI()
       fileName[6] = 'A' + selectedDrive;
       
       // ask to confirm
-      snprintf(Ui::m_stringBuffer, sizeof(Ui::m_stringBuffer)-1, Progmem::getString(Progmem::uiCreateConfirm), fileName);
-      ui->messageBox(Ui::m_stringBuffer, Progmem::getString(Progmem::uiCreateCaption));
+      ui->messageBox(UiText(Progmem::uiCreateConfirm, fileName), Progmem::uiCreateCaption);
       
-      const Ui::Button buttonRow[] = { {Ui::ButtonAction::Yes, Progmem::btnYes},
-                                       {Ui::ButtonAction::No,  Progmem::btnNo} };
-      ui->outButtons(buttonRow, BUTTONS_COUNTOF(buttonRow), DISP_WIDTH/3.5, DISP_HEIGHT/7.5);
+      ui->outButtons(&Ui::m_barYesNo);
     }
     
     else if (action == Ui::ButtonAction::Yes)
@@ -486,10 +728,9 @@ void ProcessUI()
       ui->messageBox(Progmem::uiBusy, Progmem::uiCreateCaption, false);
       
       fileName[6] = 'A' + selectedDrive;
-      strncpy(fsGetImagePath(selectedDrive), fileName, MAX_PATH);
       
       BYTE progmemResult = 0;
-      if (fsCreateAndMount(selectedDrive, progmemResult))
+      if (fsCreateAndMount(selectedDrive, fileName, progmemResult))
       {
         fsStoreDriveToEEPROM(selectedDrive); // if enabled
         
@@ -502,8 +743,7 @@ void ProcessUI()
       {
         ui->messageBox(progmemResult, Progmem::uiError);
 
-        const Ui::Button buttonRow[] = { {Ui::ButtonAction::OK, Progmem::btnOK} };
-        ui->outButtons(buttonRow, BUTTONS_COUNTOF(buttonRow), DISP_WIDTH/3.5, DISP_HEIGHT/7.5);
+        ui->outButtons(&Ui::m_barOK);
       }
     }
     
@@ -528,6 +768,7 @@ void ProcessPMD32()
   while (true)
   {
     const bool processed = pmd.processCommand();
+    fsProcessEEPROM(); // pending mount record, one byte at a time
     
     if (!processed)
     {
@@ -539,34 +780,59 @@ void ProcessPMD32()
     else
     {
       wait = millis();
+#ifdef UI_DASHBOARD
+      ProcessDashboard(); // between commands, while the host keeps the drive busy
+#endif
     }
   }
   
-  if ((mountedDrives != old) && (uiStatus == 0)) // refresh idle page if we're on it
+  if (ui && (mountedDrives != old) && (uiStatus == 0)) // refresh idle page if we're on it (display may not be up yet on boot)
   {
     ui->clearScreen();
     CardAndDriveDetails();
   }
 }
 
-void DoDrivePicker(Ui::Button* buttonRow, bool mount, bool create)
+void ProcessPendingMounts()
 {
-  if (!buttonRow)
+  // open auto-mounted drives the host has not touched yet, one per pass
+  for (BYTE drive = 0; drive < 4; drive++)
   {
+    if (!fsIsDrivePending(drive))
+    {
+      continue;
+    }
+    
+    const BYTE old = mountedDrives;
+    fsOpenPending(drive);
+    
+    if ((mountedDrives != old) && (uiStatus == 0)) // image missing or invalid, refresh idle page
+    {
+      ui->clearScreen();
+      CardAndDriveDetails();
+    }    
     return;
   }
-  
+}
+
+void DoDrivePicker(bool mount, bool create)
+{
   if (create)
   {
     ui->messageBox(Progmem::uiCreateQuestion, Progmem::uiCreateCaption);
   }
+  else if (mount && filePickerCatalog)
+  {
+    ui->messageBox(Progmem::uiFindDriveQuestion, Progmem::uiFindCaption);
+  }
   else
   {
     ui->messageBox(mount ? Progmem::uiMountQuestion : Progmem::uiUnmountQuestion, 
                    mount ? Progmem::uiMountCaption : Progmem::uiUnmountCaption);  
   }
   
-  BYTE button = 0;  
+  // A: to D:, Find and Back buttons of the table shown
+  BYTE shown = _BV(5);
   for (BYTE drive = 0; drive < 4; drive++)
   {
     bool addButton = fsIsDriveMounted(drive);
@@ -577,100 +843,171 @@ void DoDrivePicker(Ui::Button* buttonRow, bool mount, bool create)
     
     if (addButton)
     {
-      buttonRow[button].progmemCaption = Progmem::btnDriveA + drive;
-      buttonRow[button].action = Ui::ButtonAction::DriveA + drive;            
-      button++;
+      shown |= _BV(drive);
     }        
   }
-  buttonRow[button].progmemCaption = Progmem::btnBack;
-  buttonRow[button].action = Ui::ButtonAction::Back;
-  button++;
+  
+  // mounting: offer a search of the image catalog
+  if (mount && !create && !filePickerCatalog && catIsReady())
+  {
+    shown |= _BV(4);
+  }
 
-  ui->outButtons(buttonRow, button, DISP_WIDTH/7, DISP_HEIGHT/7.5);
+  ui->outButtons(&Ui::m_barDrives, shown);
 }
 
-void DoFilePicker(bool calculateTotalPages, BYTE convertSelToFileName, bool* selIsDirectory)
+void DoFilePicker(bool resetPages, BYTE convertSelToFileName, bool* selIsDirectory)
 {
-  // calculateTotalPages TRUE: filters out cwd for *.P32's, other directories and returns number of 6-entry pages to filePickerPages
+  // resetPages TRUE: cwd changed, resets selection and the page index, pages are counted in the background
   // convertSelToFilename NONZERO: converts the sel item index to non-display-shortened file name (in the cwd), returned to filePickerBuf
   //                               selIsDirectory optional: outputs true if this was a directory
   // no arguments: prepare pipe-delimited filePickerBuf and draw via ui->drawFilePicker()
-  // cwd: current working directory (fsGetImagePath), all paths MAX_PATH
+  // cwd: current working directory (filePickerPath), all paths MAX_PATH
+  // filePickerCatalog: lists catalog search hits instead, converted to their full paths
+  // filePickerSorted: lists the sorted view of the cwd, in raw directory order if there is none
   
-  // reset selection and page counts
-  if (calculateTotalPages)
+  const BYTE pickerEntries = 6;
+  if (resetPages)
   {
+    // a view built already only: sorting holds up the host, it is left for ProcessFilePickerView()
+    filePickerSorted = false;
+    filePickerViewWanted = false;
+    if (!filePickerCatalog)
+    {
+      File path;
+      fsOpenDirectory(filePickerPath, path);
+      filePickerSorted = path && dvOpen(path, filePickerView, false);
+      filePickerViewWanted = path && !filePickerSorted;
+      if (filePickerSorted)
+      {
+        filePickerHits = filePickerView.pickerCount;
+      }
+    }
+    dvPin(filePickerSorted ? &filePickerView : NULL);
+    
     filePickerPage = 1;
-    filePickerPages = 1;
+    filePickerPages = (filePickerCatalog || filePickerSorted) ? ((filePickerHits / pickerEntries) + 1) : 0; // counted already
     filePickerSel = 0;
+    
+    filePickerIndex[0] = 0;
+    filePickerIndexed = 1;
+    filePickerScanPos = 0;
+    filePickerScanCount = 1;
+    return;
   }
    
-  const char* strPath = fsGetImagePath(selectedDrive);
-  if (!strPath)
-  {
-    return;
-  }  
-  const bool isRoot = strrchr(strPath, '/') == strPath;
+  const char* strPath = filePickerPath;
+  const bool isRoot = !filePickerCatalog && (strrchr(strPath, '/') == strPath);
    
-  File path = sd.open(strPath, O_RDONLY);
-  if (!path)
+  File path;
+  if (!filePickerCatalog)
+  {
+    fsOpenDirectory(strPath, path);
+  }
+  if (!filePickerCatalog && !path)
   {
     ui->messageBox(Progmem::uiErrorFS, Progmem::uiError);
     
-    const Ui::Button buttonRow[] = { {Ui::ButtonAction::Back, Progmem::btnBack} };
-    ui->outButtons(buttonRow, BUTTONS_COUNTOF(buttonRow), DISP_WIDTH/3.5, DISP_HEIGHT/7.5);
+    ui->outButtons(&Ui::m_barBack);
     return;
   }
   
+  // sorted view pinned, it is not replaced by other directories; lost only if the directory changed
+  if (filePickerSorted && !dvIsValid(filePickerView))
+  {
+    filePickerSorted = dvOpen(path, filePickerView, false) && (filePickerView.pickerCount == filePickerHits);
+    
+    // listed anew, nothing selected; sorted again when the host is idle
+    if (!filePickerSorted)
+    {
+      DoFilePicker(true);
+      if (convertSelToFileName)
+      {
+        filePickerBuf[0] = 0;
+        return;
+      }
+    }
+  }
+  
   filePickerBuf[0] = 0;
-  const BYTE pickerEntries = 6;
   BYTE pickerEntry = (filePickerPage == 1) ? 2 : 1; // leave room for [.] / [..] if on 1st page
-  DWORD totalFilterCount = 1;
+  
+  // start from the nearest page with a known position, search hits and sorted views are all known
+  const bool listed = filePickerCatalog || filePickerSorted;
+  BYTE startPage = (filePickerPage < filePickerIndexed) ? filePickerPage : filePickerIndexed;
+  if (listed)
+  {
+    startPage = filePickerPage;
+  }
+  DWORD totalFilterCount = (startPage > 1) ? (DWORD)(startPage-1) * pickerEntries : 1;
+  WORD hit = totalFilterCount - 1;
+  if (!listed)
+  {
+    path.seekSet((DWORD)filePickerIndex[startPage-1] * 32);
+  }
     
   while (pickerEntry <= pickerEntries)
   {
-    File file = path.openNextFile(O_RDONLY);
-    if (!file)
+    char name[MAX_PATH + 1];
+    bool isDirectory = false;
+    RawDirEntry entry;
+    bool rawListed = false;
+    
+    if (filePickerCatalog)
     {
-      break;
+      CatalogRecord record;
+      if ((hit >= filePickerHits) || !catGetRecord(filePickerFirst + hit, record))
+      {
+        break;
+      }
+      hit++;
+      
+      strcpy(name, record.name);
+      // image gone, its record dropped: nothing to open, the hits are searched again and the page redrawn
+      if ((convertSelToFileName == pickerEntry) && !catResolve(filePickerFirst + hit - 1, record, name, sizeof(name)))
+      {
+        filePickerFirst = catFind(findPrefix, filePickerHits);
+        filePickerPages = (filePickerHits / pickerEntries) + 1;
+        if (filePickerPage > filePickerPages)
+        {
+          filePickerPage = filePickerPages;
+        }
+        filePickerSel = 0;
+        filePickerBuf[0] = 0;
+        return;
+      }
     }
-
-    if (file.isHidden())
+    else if (filePickerSorted)
     {
-      file.close();
-      continue;
+      if ((hit >= filePickerHits) || !dvGetEntry(filePickerView, path, hit, name, sizeof(name), isDirectory))
+      {
+        break;
+      }
+      hit++;
     }
-    
-    // filter *.p32
-    char name[MAX_PATH + 1];
-    name[0] = 0;
-    file.getName(name, MAX_PATH);  
-    bool isDirectory = file.isDir() || file.isSubDir();
-    file.close();
-    if (!strlen(name))
-    {
-      continue;
-    }    
-    if (!isDirectory)
+    else
     {
-      const char* ext = strcasestr(name, ".p32");
-      if (!ext)
+      // filtered by the raw entry, the name is read only when shown
+      if (!FilePickerNextEntry(path, entry, rawListed))
       {
-        continue;
+        break;
       }
-      
-      // also ending with it?
-      const BYTE extPos = ext-&name[0];
-      if (extPos != strlen(name)-4)
+      if (!rawListed)
       {
         continue;
       }
+      strcpy(name, entry.shortName);
+      isDirectory = entry.isDirectory;
+    }
+    if (!strlen(name))
+    {
+      continue;
     }
     
     totalFilterCount++;
-    if (calculateTotalPages)
+    if (rawListed)
     {
-      continue; // until !file
+      FilePickerIndexPage(totalFilterCount, entry.position);
     }
     
     const DWORD currentPage = ((totalFilterCount-1) / (DWORD)pickerEntries) + 1;
@@ -679,6 +1016,11 @@ void DoFilePicker(bool calculateTotalPages, BYTE convertSelToFileName, bool* sel
       continue;
     }
     
+    if (rawListed && (!convertSelToFileName || (convertSelToFileName == pickerEntry)))
+    {
+      fsGetRawEntryName(path, entry, name, sizeof(name));
+    }
+    
     if (convertSelToFileName)
     {      
       if (convertSelToFileName == pickerEntry)
@@ -698,7 +1040,7 @@ void DoFilePicker(bool calculateTotalPages, BYTE convertSelToFileName, bool* sel
     
     // continue with picker
     // trim long file/dir names for the display
-    const BYTE maxShownNameLen = file.isDir() ? 30 : 32; // 32 chars (30 for directories inside brackets)  
+    const BYTE maxShownNameLen = isDirectory ? 30 : 32; // 32 chars (30 for directories inside brackets)  
     if (isDirectory)
     { 
       if (strlen(name) > maxShownNameLen)
@@ -727,13 +1069,225 @@ void DoFilePicker(bool calculateTotalPages, BYTE convertSelToFileName, bool* sel
     pickerEntry++;
   }
   
-  if (calculateTotalPages)
+  ui->drawFilePicker(isRoot, filePickerBuf, filePickerSel, filePickerPage, filePickerPages);
+}
+
+bool FilePickerNextEntry(File& dir, RawDirEntry& entry, bool& listed)
+{
+  // reads the next raw directory entry, listed: not filtered out (directories, *.p32)
+  // false: end of directory
+  listed = false;
+  if (!fsReadRawEntry(dir, entry))
+  {
+    return false;
+  }
+  
+  listed = !entry.isHidden && (entry.isDirectory || entry.isImage);
+  return true;
+}
+
+void FilePickerIndexPage(DWORD count, DWORD position)
+{
+  // count: entry number incl. [.] or [..], position: where the entry started
+  // remembers the position of each first entry of a page, in order
+  const BYTE pickerEntries = 6;
+  if ((count < 2) || ((count-1) % pickerEntries))
   {
-    filePickerPages = ((totalFilterCount-1) / (DWORD)pickerEntries)+1;
     return;
   }
   
-  ui->drawFilePicker(isRoot, filePickerBuf, filePickerSel, filePickerPage, filePickerPages);
+  const DWORD page = ((count-1) / pickerEntries) + 1;
+  if ((page != (DWORD)filePickerIndexed + 1) || (filePickerIndexed >= PICKER_INDEX_PAGES))
+  {
+    return;
+  }
+  
+  filePickerIndex[filePickerIndexed++] = position / 32;
+}
+
+bool FilePickerHasPage(WORD page)
+{
+  // page count not known yet: let the background count reach the page first
+  while (!filePickerPages && (page > filePickerIndexed))
+  {
+    ProcessFilePickerIndex();
+  }
+  
+  return (page <= filePickerIndexed) || (page <= filePickerPages);
+}
+
+void ProcessFilePickerIndex()
+{
+  // counts file picker pages a few directory entries per pass, shows the total when done
+  if (filePickerPages)
+  {
+    return;
+  }
+  
+  const BYTE pickerEntries = 6;
+  bool done = true;
+  
+  File path;
+  if (fsOpenDirectory(filePickerPath, path) && path.seekSet(filePickerScanPos))
+  {
+    for (BYTE entry = 0; entry < 16; entry++)
+    {
+      RawDirEntry raw;
+      bool listed = false;
+      
+      done = !FilePickerNextEntry(path, raw, listed);
+      if (done)
+      {
+        break;
+      }
+      
+      if (listed)
+      {
+        filePickerScanCount++;
+        FilePickerIndexPage(filePickerScanCount, raw.position);
+      }
+    }
+    
+    filePickerScanPos = path.curPosition();
+    path.close();
+  }
+  
+  if (done)
+  {
+    filePickerPages = ((filePickerScanCount-1) / pickerEntries) + 1;
+    ui->drawFilePickerDetails(filePickerPage, filePickerPages);
+  }
+}
+
+void ProcessFilePickerView()
+{
+  // sorted view of the cwd listed in raw order, built once the host is idle and the pages are counted;
+  // shown right away if nothing is selected, otherwise the next time the directory is entered
+  if (!filePickerViewWanted || !filePickerPages || !pmd.isHostIdle())
+  {
+    return;
+  }
+  
+  filePickerViewWanted = false;
+  File path;
+  DirView view;
+  if (!fsOpenDirectory(filePickerPath, path) || !dvOpen(path, view) || filePickerSel)
+  {
+    return;
+  }
+  path.close();
+  
+  DoFilePicker(true);
+  DoFilePicker();
+}
+
+#ifdef UI_DASHBOARD
+void ProcessDashboard(bool whole)
+{
+  // idle page: drive indicators every DASHBOARD_ACTIVITY_MS, rates every DASHBOARD_RATES_MS, whole: the page is drawn again;
+  // what did not change is not drawn again, a pass that does nothing costs a few comparisons
+  if (!ui || (uiStatus != 0) || (cardStatus != 3))
+  {
+    // rates only over the time the page is shown
+    dashboardLast = pmd.getStats();
+    dashboardRatesTime = millis();
+    return;
+  }
+  
+  const DWORD now = millis();
+  const bool rates = (now - dashboardRatesTime) >= DASHBOARD_RATES_MS;
+  if (!whole && !rates && ((now - dashboardActivityTime) < DASHBOARD_ACTIVITY_MS))
+  {
+    return;
+  }
+  dashboardActivityTime = now;
+  
+  const PMD32::Stats& stats = pmd.getStats();
+  if (rates)
+  {
+    const DWORD elapsed = now - dashboardRatesTime;
+    const WORD accesses = stats.blockAccesses - dashboardLast.blockAccesses;
+    const DWORD KB10 = ((stats.bytes - dashboardLast.bytes) * 625) / (elapsed * 64); // x10000/1024
+    
+    dashboardKB10 = (KB10 > 0xFFFF) ? 0xFFFF : KB10;
+    dashboardCommands = ((DWORD)(WORD)(stats.commands - dashboardLast.commands) * 1000) / elapsed;
+    if (accesses)
+    {
+      dashboardHits = ((DWORD)(WORD)(stats.blockHits - dashboardLast.blockHits) * 100) / accesses;
+    }
+    dashboardLast = stats;
+    dashboardRatesTime = now;
+  }
+  
+  // drive indicators: lit green reading, red writing
+  ui->setCursor(DISP_WIDTH*0.19, DISP_HEIGHT*0.35);
+  for (BYTE drive = 0; drive < 4; drive++)
+  {
+    BYTE indicator = fsIsDriveMounted(drive) ? Ui::IndicatorIdle : Ui::IndicatorOff;
+    if (stats.driveTime[drive] && ((now - stats.driveTime[drive]) < DASHBOARD_BUSY_MS))
+    {
+      indicator = (stats.driveWrites & (1 << drive)) ? Ui::IndicatorWrite : Ui::IndicatorRead;
+    }
+    
+    ui->outText(Progmem::btnDriveA + drive);
+    ui->setCursorX(ui->getCursorX() + 4);
+    ui->outIndicator(indicator);
+    ui->setCursorX(ui->getCursorX() + 24);
+  }
+  
+  if (!whole && !rates)
+  {
+    return;
+  }
+  
+  // throughput right aligned in 4 big cells, one decimal below 100 KB/s
+  char value[6];
+  utoa(dashboardKB10 / 10, value, 10);
+  BYTE length = strlen(value);
+  if (dashboardKB10 < 1000)
+  {
+    value[length++] = '.';
+    value[length++] = '0' + (dashboardKB10 % 10);
+    value[length] = 0;
+  }
+  char cells[] = "    ";
+  memcpy(&cells[4 - length], value, length);
+  ui->setCursor(DISP_WIDTH/6, DISP_HEIGHT*0.63);
+  ui->outSevenSeg(cells);
+  
+  ui->setCursor(DISP_WIDTH*0.6, DISP_HEIGHT*0.48);
+  ui->outText(Progmem::uiDashKBs);
+  ui->setCursor(DISP_WIDTH*0.6, DISP_HEIGHT*0.555);
+  ui->outText(UiText(Progmem::uiDashNAKs, stats.naks));
+  ui->setCursor(DISP_WIDTH*0.6, DISP_HEIGHT*0.63);
+  ui->outText(UiText(Progmem::uiDashTimeouts, stats.timeouts));
+  
+  const char last = ((stats.lastCommand >= ' ') && (stats.lastCommand < 0x7F)) ? stats.lastCommand : '-';
+  ui->setCursorY(DISP_HEIGHT*0.72);
+  ui->outText(UiText(Progmem::uiDashActivity, dashboardCommands, dashboardHits, last), true);
+}
+#endif
+
+void DoFindPrompt(bool redrawWhole)
+{
+  // name prefix for the catalog search: cycle through characters, add or delete one, search
+  if (redrawWhole)
+  {
+    ui->clearScreen();
+    ui->setCursorY(DISP_HEIGHT*0.33);
+    ui->outText(Progmem::uiFindQuestion, true);
+    
+    if (catIsIndexing())
+    {
+      ui->setCursorY(DISP_HEIGHT*0.63);
+      ui->outText(Progmem::uiFindIndexing, true);
+    }
+    
+    ui->outButtons(&Ui::m_barFindPrompt);
+  }
+  
+  ui->setCursorY(DISP_HEIGHT*0.48);
+  ui->outText(UiText(Progmem::uiFindPrompt, findPrefix, findCharset[findChar]), true, false, !redrawWhole);
 }
 
 #endif // TOUCH_SCREEN_CALIBRATION
\ No newline at end of file
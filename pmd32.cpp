@@ -19,12 +19,34 @@ PMD32::PMD32()
   m_CRC = 0; // 8-bit XOR
   m_hostResponding = false; // accepting commands
   
+  memset(&m_stats, 0, sizeof(m_stats));
+  m_inCommand = false;
+  m_lastDrive = 0xFF;
+  m_lastBlock = 0;
+  
   // sector data buffer, and for string I/O
   memset(m_ioBuffer, 0, sizeof(m_ioBuffer));
   
   // PMD32-SD path string for use with CD.COM that keeps current working directory
   memset(m_cwdPath, 0, sizeof(m_cwdPath));
   m_cwdPath[0] = '/';
+  
+  m_dirSorted = false;
+  m_dirViewWanted = false;
+  m_dirNext = 0;
+  m_commandTime = 0;
+  
+  m_findFirst = 0;
+  m_findCount = 0;
+  m_findNext = 0;
+  
+#ifdef PMD32_LATENCY
+  latencyReset();
+  m_stamped = 0;
+  m_latencyDrive = 0xFF;
+  m_serialRow = 0xFF;
+  m_serialColumn = 0;
+#endif
 }
 
 bool PMD32::processCommand()
@@ -63,6 +85,12 @@ bool PMD32::processCommand()
   }
   
   m_CRC = command; // command byte also part of CRC
+  m_commandTime = millis();
+  LATENCY_MARK(LatencyCommand);
+  LATENCY_DRIVE(0xFF);
+  m_stats.commands++;
+  m_stats.lastCommand = command;
+  m_inCommand = true;
   
   switch(command)
   {
@@ -124,16 +152,47 @@ bool PMD32::processCommand()
   case PMD32_IMAGE_INFO:
     extraImageInfo();
     break;
+  case PMD32_FIND_IMAGE:
+    extraFindImage();
+    break;
+#ifdef PMD32_LATENCY
+  case PMD32_GET_LATENCY:
+    extraGetLatency();
+    break;
+#endif
     
   // unrecognized
   default:
-    sendByte(PMD32_NAK, TIMEOUT_SEND_NAK);
+    sendNAK();
+    m_inCommand = false;
     return false;
   }
   
+  m_inCommand = false;
+#ifdef PMD32_LATENCY
+  latencyCommit(command);
+#endif
   return true;
 }
 
+void PMD32::processIdle()
+{
+  if (!m_dirViewWanted || !isHostIdle())
+  {
+    return;
+  }
+  
+  // sorted view of the directory the host listed last, for its next listing
+  m_dirViewWanted = false;
+  File dir;
+  if (fsOpenDirectory(m_cwdPath, dir))
+  {
+    DirView view;
+    dvOpen(dir, view);
+    dir.close();
+  }
+}
+
 void PMD32::doRWOperation(bool write, bool format, bool readBootSector, WORD bytes)
 {
   // sanity check :-)
@@ -218,6 +277,7 @@ void PMD32::doRWOperation(bool write, bool format, bool readBootSector, WORD byt
     data = PMD32_READ_ERROR;
   }
   
+  LATENCY_DRIVE(drive);
   File* file = fsGetFile(drive);
   if (file && file->isOpen())
   {
@@ -229,6 +289,21 @@ void PMD32::doRWOperation(bool write, bool format, bool readBootSector, WORD byt
     }    
     file->seekSet(offset);
     
+    // the SdFat cache holds the 512B block accessed last, whichever drive it was
+    if (!format)
+    {
+      const DWORD block = offset >> 9;
+      m_stats.blockAccesses++;
+      if ((drive == m_lastDrive) && (block == m_lastBlock))
+      {
+        m_stats.blockHits++;
+      }
+      m_lastDrive = drive;
+      m_lastBlock = block;
+    }
+    m_stats.driveTime[drive] = millis();
+    m_stats.driveWrites = (write || format) ? (m_stats.driveWrites | (1 << drive)) : (m_stats.driveWrites & ~(1 << drive));
+    
     if (write)
     {
       if (!file->isWritable()) // read-only or write protected
@@ -258,6 +333,7 @@ void PMD32::doRWOperation(bool write, bool format, bool readBootSector, WORD byt
         }
         
         file->sync();
+        m_lastDrive = 0xFF;
         data = PMD32_OK;
       }
     }
@@ -277,10 +353,11 @@ void PMD32::doRWOperation(bool write, bool format, bool readBootSector, WORD byt
   }
   
   // nothing follows if the I/O operation failed
-  if (!sendByte(data, TIMEOUT_SEND_RESULT) || (data != PMD32_OK))
+  if (!sendResult(data) || (data != PMD32_OK))
   {
     return;
   }
+  m_stats.bytes += format ? (36*128) : bytes;
   
   // read, read bootsector - pass on buffer and CRC
   if (!write && !format)
@@ -315,13 +392,17 @@ void PMD32::changeDrive()
   }
   
   data = PMD32_INVALID_DRIVE;
+  if (drive < 4)
+  {
+    LATENCY_DRIVE(drive);
+  }
   File* file = fsGetFile(drive);
   if (file && file->isOpen())
   {
     data = PMD32_OK;
   }
   
-  sendByte(data, TIMEOUT_SEND_RESULT);
+  sendResult(data);
 }
 
 void PMD32::dummyCommand(BYTE inputArgumentsCount, BYTE outputZerosCount)
@@ -381,9 +462,10 @@ bool PMD32::readByte(BYTE& data, DWORD timeout, bool checkCRC)
   }  
   if (!read) // failed
   {
+    m_stats.timeouts += m_inCommand;
     if (checkCRC)
     {
-      sendByte(PMD32_NAK, TIMEOUT_SEND_NAK);
+      sendNAK();
     }
     return false;
   }
@@ -399,13 +481,29 @@ bool PMD32::readByte(BYTE& data, DWORD timeout, bool checkCRC)
   {
     if (sendByte(PMD32_ACK, TIMEOUT_SEND_ACK))
     {
+      LATENCY_MARK(LatencyArguments);
       return true;
     }
   }
-  sendByte(PMD32_NAK, TIMEOUT_SEND_NAK);
+  sendNAK();
   return false;
 }
 
+void PMD32::sendNAK()
+{
+  m_stats.naks++;
+  sendByte(PMD32_NAK, TIMEOUT_SEND_NAK);
+}
+
+bool PMD32::sendResult(BYTE data)
+{
+  // whatever was between the arguments and this was the SD I/O
+  LATENCY_MARK(LatencyIO);
+  const bool sent = sendByte(data, TIMEOUT_SEND_RESULT);
+  LATENCY_MARK(LatencyResult);
+  return sent;
+}
+
 bool PMD32::sendByte(BYTE data, DWORD timeout)
 {  
   // DIR low, data lines as output and write  
@@ -430,6 +528,11 @@ bool PMD32::sendByte(BYTE data, DWORD timeout)
     }
   }
   
+  if (!result && timeout)
+  {
+    m_stats.timeouts += m_inCommand;
+  }
+  
   // data lines hi-impedance, DIR high
   PMD_DATA_DDR = 0;
   PMD_DATA_OUT = 0;
@@ -488,8 +591,12 @@ void PMD32::extraGetImagePath()
   {
     if (file->isOpen())
     {
+      // reconstruct the path before answering, whole; truncated for CD.COM when sent
+      m_ioBuffer[0] = 0;
+      fsGetImagePath(drive, m_ioBuffer, MAX_PATH + 1);
+      
       // ERR 0
-      if (!sendByte(PMD32_OK, TIMEOUT_SEND_RESULT))
+      if (!sendResult(PMD32_OK))
       {
         return;
       } 
@@ -503,13 +610,13 @@ void PMD32::extraGetImagePath()
       }
            
       //PMD32-Mega2560 has MAX_PATH defined 255, but truncate this for CD.COM to 63 bytes
-      const char* path = fsGetImagePath(drive) + 1; // skip the root '/'
+      const char* path = m_ioBuffer[0] ? &m_ioBuffer[1] : ""; // skip the root '/'
       extraSendMaxLengthString(63, path);
     }
     else
     {
       // drive not mounted
-      if (!sendByte(PMD32_OK, TIMEOUT_SEND_RESULT)) // ERR 0
+      if (!sendResult(PMD32_OK)) // ERR 0
       {
         return;
       }
@@ -522,7 +629,7 @@ void PMD32::extraGetImagePath()
   else
   {
     // ERR invalid drive number
-    sendByte(PMD32_INVALID_DRIVE, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_INVALID_DRIVE);
   }
 }
 
@@ -575,40 +682,35 @@ void PMD32::extraMountImage()
   
   if (drive > 3)
   {
-    sendByte(PMD32_INVALID_DRIVE, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_INVALID_DRIVE);
     return;
   }
   
   fsUnmount(drive);  
   if (length == 0) // unmount only
   {
-    sendByte(PMD32_OK, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_OK);
     return;
   }
  
   // mount new or remount same image with new O_RDONLY/O_RDWR flag
-  if (length != 0xFF)
-  {
-    strncpy(fsGetImagePath(drive), m_ioBuffer, MAX_PATH);
-  }
-  
-  if (fsMount(drive, data, readOnly))
+  if (fsMount(drive, (length != 0xFF) ? m_ioBuffer : NULL, data, readOnly))
   {
-    sendByte(PMD32_OK, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_OK);
   }
   
   // get error code
   else if (data == Progmem::uiErrorFileOpen)
   {
-    sendByte(PMD32_PATH_NOT_FOUND, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_PATH_NOT_FOUND);
   }
   else if (data == Progmem::uiErrorFileSize)
   {
-    sendByte(PMD32_IMAGE_UNKNOWN, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_IMAGE_UNKNOWN);
   }
   else
   {
-    sendByte(PMD32_NAK, TIMEOUT_SEND_RESULT); // image already mounted, etc
+    sendResult(PMD32_NAK); // image already mounted, etc
   }
 }
 
@@ -649,28 +751,65 @@ void PMD32::extraDoDirectoryListing()
       m_dirListing.close();
     }
     
-    m_dirListing = sd.open(m_cwdPath, O_RDONLY);
-    if (!m_dirListing.isOpen())
+    if (!fsOpenDirectory(m_cwdPath, m_dirListing))
     {
-      sendByte(PMD32_PATH_NOT_FOUND, TIMEOUT_SEND_RESULT);
+      sendResult(PMD32_PATH_NOT_FOUND);
       return;
     }
     
+    // sorted if a view is built already, raw directory order otherwise;
+    // building one takes too long for the host, and writes the card, so it is left for processIdle()
+    m_dirSorted = dvOpen(m_dirListing, m_dirView, false);
+    m_dirViewWanted = !m_dirSorted;
+    m_dirNext = 0;
+    
     // root or one level up
     const bool isRoot = strrchr(m_cwdPath, '/') == m_cwdPath;
     strcpy(m_ioBuffer, isRoot ? "[.]" : "[..]");
   }
 
+  else if (m_dirListing.isOpen() && m_dirSorted) // next entry, sorted
+  {
+    bool isDirectory = false;
+    if ((m_dirNext < m_dirView.count) && dvGetEntry(m_dirView, m_dirListing, m_dirNext++, &m_ioBuffer[1], 63 + 1, isDirectory))
+    {
+      // [DIRECTORY] in brackets, 63 char maximum for PMD32-SD
+      if (isDirectory)
+      {
+        m_ioBuffer[0] = '[';
+        m_ioBuffer[1 + 61] = 0;
+        strcat(m_ioBuffer, "]");
+      }
+      else
+      {
+        memmove(m_ioBuffer, &m_ioBuffer[1], 63 + 1);
+      }
+    }
+    
+    // no more files (or the view was rebuilt for another directory meanwhile), close directory listing
+    else
+    {
+      m_ioBuffer[0] = 0;
+      m_dirListing.close();
+    }
+  }
+
   else if (m_dirListing.isOpen()) // next entry
   {
-    File file = m_dirListing.openNextFile(O_RDONLY);
-    if (file)
+    // raw entry, the long name is read only if there is one
+    RawDirEntry entry;
+    bool found = fsReadRawEntry(m_dirListing, entry);
+    while (found && entry.isHidden) // as in the sorted listing
+    {
+      found = fsReadRawEntry(m_dirListing, entry);
+    }
+    
+    if (found)
     {   
-      bool isDirectory = file.isDir() || file.isSubDir();
+      bool isDirectory = entry.isDirectory;
       const BYTE maxLen = isDirectory ? 61 : 63; // [DIRECTORY] in brackets, 63 char maximum for PMD32-SD
       m_ioBuffer[0] = isDirectory ? '[' : 0;
-      file.getName(&m_ioBuffer[isDirectory ? 1 : 0], maxLen); 
-      file.close();
+      fsGetRawEntryName(m_dirListing, entry, &m_ioBuffer[isDirectory ? 1 : 0], maxLen);
       if (isDirectory)
       {
         strcat(m_ioBuffer, "]");
@@ -721,7 +860,7 @@ void PMD32::extraChangeCurrentWorkingDirectory()
   const char* supplied = &m_ioBuffer[startIndex];
   if (strcmp(supplied, ".") == 0)
   {
-    sendByte(PMD32_OK, TIMEOUT_SEND_RESULT); // . supplied, don't do anything
+    sendResult(PMD32_OK); // . supplied, don't do anything
     return;
   }
   else if (strcmp(supplied, "..") == 0) // .., one level up
@@ -737,7 +876,7 @@ void PMD32::extraChangeCurrentWorkingDirectory()
       }
     }
     
-    sendByte(PMD32_OK, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_OK);
     return;
   }
    
@@ -750,21 +889,21 @@ void PMD32::extraChangeCurrentWorkingDirectory()
   // too long?
   if (strlen(m_ioBuffer) > sizeof(m_cwdPath)-1) // 64, but we send out max 63 chars as the root '/' is skipped
   {
-    sendByte(PMD32_PATH_TOO_LONG, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_PATH_TOO_LONG);
     return;
   }
   
-  // check if the new working directory exists by doing a chdir operation
-  if (!sd.chdir(m_ioBuffer))
+  // check if the new working directory exists
+  File dir;
+  if (!fsOpenDirectory(m_ioBuffer, dir))
   {
-    sd.chdir(m_cwdPath); // last good known
-    sendByte(PMD32_PATH_NOT_FOUND, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_PATH_NOT_FOUND);
     return;
   }  
   
   // OK, update cwd
   strncpy(m_cwdPath, m_ioBuffer, sizeof(m_cwdPath)-1);
-  sendByte(PMD32_OK, TIMEOUT_SEND_RESULT);
+  sendResult(PMD32_OK);
 }
 
 void PMD32::extraCreateImage() // but do not mount
@@ -804,15 +943,17 @@ void PMD32::extraCreateImage() // but do not mount
   
   if (strlen(m_ioBuffer) > sizeof(m_cwdPath)-1)
   {
-    sendByte(PMD32_PATH_TOO_LONG, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_PATH_TOO_LONG);
     return;
   }
   
   // now try to create
-  File file = sd.open(m_ioBuffer, O_RDWR | O_CREAT | O_TRUNC);
-  if (!file)
+  ImageLocator locator;
+  File file;
+  BYTE progmemResult;
+  if (!fsOpenPath(m_ioBuffer, locator, file, O_RDWR | O_CREAT | O_TRUNC, progmemResult))
   {
-    sendByte(PMD32_CREATE_ERROR, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_CREATE_ERROR);
     return;
   }
   
@@ -827,14 +968,16 @@ void PMD32::extraCreateImage() // but do not mount
     if (!file.write(m_ioBuffer, bufSize))
     {
       file.close();
-      sendByte(PMD32_CREATE_ERROR, TIMEOUT_SEND_RESULT);
+      sendResult(PMD32_CREATE_ERROR);
       return;
     }      
     count--;
   }
   
+  locator.sector = file.firstSector();
+  catAddImage(locator);
   file.close();
-  sendByte(PMD32_OK, TIMEOUT_SEND_RESULT);
+  sendResult(PMD32_OK);
 }
 
 void PMD32::extraImageInfo()
@@ -853,17 +996,17 @@ void PMD32::extraImageInfo()
   
   if (drive > 3)
   {
-    sendByte(PMD32_INVALID_DRIVE, TIMEOUT_SEND_RESULT);
+    sendResult(PMD32_INVALID_DRIVE);
     return;
   }
   
-  if (!sendByte(PMD32_OK, TIMEOUT_SEND_RESULT))
+  if (!sendResult(PMD32_OK))
   {
     return;
   }
   
   // 360K P32 in a PMD 85; 36x128B logical sectors (9x512B physical), 2 sides, 40 tracks per side
-  const bool isDriveMounted = fsIsDriveMounted(drive);
+  const bool isDriveMounted = fsOpenPending(drive); // also opens a lazily mounted drive
   const BYTE tracks = isDriveMounted ? 80 : 0; // meant on both sides
   const BYTE sect128BPerTrack = isDriveMounted ? 36 : 0;
   const BYTE physSectorSize = isDriveMounted ? 2 : 0; // 2: 512B
@@ -892,4 +1035,323 @@ void PMD32::extraImageInfo()
   sendByte(m_CRC);
 }
 
+void PMD32::extraFindImage()
+{
+  // catalog search by name prefix, one hit per call like the directory listing
+  // first call: 0, prefix length, prefix; next calls: 1
+  // answers ERR, then the full path of the hit (without the root '/'), empty if no more
+  BYTE nextHit;
+  if (!readByte(nextHit))
+  {
+    return;
+  }
+  
+  BYTE length = 0;
+  if (!nextHit)
+  {
+    if (!readByte(length))
+    {
+      return;
+    }
+    
+    for (WORD index = 0; index < length; index++)
+    {
+      if (!readByte(m_ioBuffer[index]))
+      {
+        return;
+      }
+    }
+    m_ioBuffer[length] = 0;
+  }
+  
+  BYTE data;
+  if (!readByte(data, TIMEOUT_READ, true))
+  {
+    return;
+  }
+  m_CRC = 0;
+  
+  if (!catIsReady())
+  {
+    sendResult(PMD32_PATH_NOT_FOUND);
+    return;
+  }
+  
+  if (!nextHit)
+  {
+    m_findFirst = catFind(m_ioBuffer, m_findCount);
+    m_findNext = 0;
+  }
+  
+  if (!sendResult(PMD32_OK))
+  {
+    return;
+  }
+  
+  // skip hits that no longer resolve, dropped from the catalog: the next one moves up
+  m_ioBuffer[0] = 0;
+  while (m_findNext < m_findCount)
+  {
+    CatalogRecord record;
+    if (catResolve(m_findFirst + m_findNext, record, m_ioBuffer, sizeof(m_ioBuffer)))
+    {
+      m_findNext++;
+      break;
+    }
+    
+    m_findCount--;
+    m_ioBuffer[0] = 0;
+  }
+  
+  const char* path = m_ioBuffer[0] ? &m_ioBuffer[1] : "";
+  extraSendMaxLengthString(63, path);
+}
+
+#ifdef PMD32_LATENCY
+
+// row names over the serial port, 7 characters each: classes, then phases
+static const char latencyNames[] PROGMEM = "read   write  fmt/selextra  other  args   sd     result payload";
+
+void PMD32::beginLatency()
+{
+  // init() left timer 1 in 8-bit PWM at clk/64; normal mode at clk/8 instead, no interrupts
+  TCCR1A = 0;
+  TCCR1B = _BV(CS11);
+  Serial.begin(LATENCY_BAUD);
+}
+
+void PMD32::latencyMark(BYTE stamp)
+{
+  // a few register reads, the host is not kept waiting
+  if (stamp == LatencyCommand)
+  {
+    m_stamped = 0;
+  }
+  m_stampTicks[stamp] = TCNT1;
+  m_stampTime[stamp] = millis();
+  m_stamped |= 1 << stamp;
+}
+
+void PMD32::latencyRecord(BYTE table, BYTE from, BYTE to)
+{
+  // phases not reached by an aborted command are left out
+  const BYTE both = (1 << from) | (1 << to);
+  if ((m_stamped & both) != both)
+  {
+    return;
+  }
+  
+  // the ticks wrap after 32.768ms, millis() is within 1.024ms before that
+  const DWORD ms = m_stampTime[to] - m_stampTime[from];
+  const DWORD us = (ms >= 30) ? ms * 1000 : (WORD)(m_stampTicks[to] - m_stampTicks[from]) >> 1;
+  
+  BYTE bucket = LATENCY_BUCKETS - 1;
+  if (us < (4UL << (LATENCY_BUCKETS - 2)))
+  {
+    bucket = 0;
+    for (WORD quarters = us >> 2; quarters; quarters >>= 1)
+    {
+      bucket++;
+    }
+  }
+  
+  WORD& count = m_latency[table][bucket];
+  if (count != 0xFFFF)
+  {
+    count++;
+  }
+}
+
+void PMD32::latencyCommit(BYTE command)
+{
+  latencyMark(LatencyEnd);
+  
+  BYTE type = 4;
+  switch(command)
+  {
+  case PMD32_READ_BOOT:
+  case PMD32_READ_LOGICAL1:
+  case PMD32_READ_LOGICAL2:
+    type = 0;
+    break;
+  case PMD32_WRITE_LOGICAL1:
+  case PMD32_WRITE_LOGICAL2:
+  case PMD32_WRITE_PHYSICAL:
+    type = 1;
+    break;
+  case PMD32_FORMAT_TRACK:
+  case PMD32_CHANGE_DRIVE:
+    type = 2;
+    break;
+  case PMD32_GET_IMAGE_PATH:
+  case PMD32_MOUNT_IMAGE:
+  case PMD32_GET_CWD:
+  case PMD32_DIR_LISTING:
+  case PMD32_CHANGE_CWD:
+  case PMD32_CREATE_IMAGE:
+  case PMD32_IMAGE_INFO:
+  case PMD32_FIND_IMAGE:
+  case PMD32_GET_LATENCY:
+    type = 3;
+    break;
+  }
+  
+  for (BYTE phase = 0; phase < LATENCY_PHASES; phase++)
+  {
+    latencyRecord(type * LATENCY_PHASES + phase, phase, phase + 1);
+  }
+  if (m_latencyDrive < 4)
+  {
+    latencyRecord(LATENCY_CLASSES * LATENCY_PHASES + m_latencyDrive, LatencyCommand, LatencyEnd);
+  }
+}
+
+void PMD32::latencyReset()
+{
+  memset(m_latency, 0, sizeof(m_latency));
+}
+
+void PMD32::processSerial()
+{
+  while (Serial.available())
+  {
+    const int received = Serial.read();
+    if (received == 'h')
+    {
+      m_serialRow = 0;
+      m_serialColumn = 0;
+    }
+    else if (received == 'r')
+    {
+      latencyReset();
+      Serial.println(F("reset"));
+    }
+  }
+  
+  // a piece at a time, only while the transmit buffer has room for it:
+  // a full buffer would block Serial.print(), stalling the host
+  while ((m_serialRow < LATENCY_TABLES) && (Serial.availableForWrite() >= 16))
+  {
+    // header line: the label, LATENCY_BUCKETS - 1 limits, then the last bucket
+    BYTE column = m_serialColumn++;
+    if (!m_serialRow && (column <= LATENCY_BUCKETS))
+    {
+      if (!column)
+      {
+        Serial.print(F("us <          "));
+      }
+      else if (column < LATENCY_BUCKETS)
+      {
+        Serial.print(' ');
+        Serial.print(4UL << (column - 1));
+      }
+      else
+      {
+        Serial.println(F(" more"));
+      }
+      continue;
+    }
+    if (!m_serialRow)
+    {
+      column -= LATENCY_BUCKETS + 1;
+    }
+    
+    // row: the label, LATENCY_BUCKETS counts, then the line end
+    if (column)
+    {
+      if (column <= LATENCY_BUCKETS)
+      {
+        Serial.print(' ');
+        Serial.print(m_latency[m_serialRow][column - 1]);
+      }
+      else
+      {
+        Serial.println();
+        m_serialRow++;
+        m_serialColumn = 0;
+      }
+    }
+    else if (m_serialRow < LATENCY_CLASSES * LATENCY_PHASES)
+    {
+      const BYTE type = m_serialRow / LATENCY_PHASES;
+      const BYTE phase = LATENCY_CLASSES + m_serialRow % LATENCY_PHASES;
+      for (BYTE index = 0; index < 7; index++)
+      {
+        Serial.print((char)pgm_read_byte(&latencyNames[type * 7 + index]));
+      }
+      for (BYTE index = 0; index < 7; index++)
+      {
+        Serial.print((char)pgm_read_byte(&latencyNames[phase * 7 + index]));
+      }
+    }
+    else
+    {
+      Serial.print((char)('A' + m_serialRow - LATENCY_CLASSES * LATENCY_PHASES));
+      Serial.print(F(": total      "));
+    }
+  }
+}
+
+void PMD32::extraGetLatency()
+{
+  // selector: table (bits 0-6), classes times phases first, then drives A: to D:; bit 7: reset all afterwards
+  BYTE selector;
+  if (!readByte(selector))
+  {
+    return;
+  }
+  BYTE data;
+  if (!readByte(data, TIMEOUT_READ, true))
+  {
+    return;
+  }
+  m_CRC = 0;
+  
+  const BYTE table = selector & 0x7F;
+  if (table >= LATENCY_TABLES)
+  {
+    sendResult(PMD32_NAK);
+    return;
+  }
+  
+  if (!sendResult(PMD32_OK))
+  {
+    return;
+  }
+  
+  // bucket count, then the counts, LSB first
+  data = LATENCY_BUCKETS;
+  m_CRC ^= data;
+  if (!sendByte(data))
+  {
+    return;
+  }
+  
+  for (BYTE bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+  {
+    const WORD count = m_latency[table][bucket];
+    
+    data = count & 0xFF;
+    m_CRC ^= data;
+    if (!sendByte(data))
+    {
+      return;
+    }
+    
+    data = count >> 8;
+    m_CRC ^= data;
+    if (!sendByte(data))
+    {
+      return;
+    }
+  }
+  
+  if (sendByte(m_CRC) && (selector & 0x80))
+  {
+    latencyReset();
+  }
+}
+
+#endif // PMD32_LATENCY
+
 #endif // TOUCH_SCREEN_CALIBRATION
\ No newline at end of file
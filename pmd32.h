@@ -42,7 +42,9 @@
 #define PMD32_DIR_LISTING    0x4C // 'L'
 #define PMD32_CHANGE_CWD     0x4D // 'M'
 #define PMD32_CREATE_IMAGE   0x4E // 'N'
+#define PMD32_FIND_IMAGE     0x4F // 'O'
 #define PMD32_IMAGE_INFO     0x50 // 'P'
+#define PMD32_GET_LATENCY    0x56 // 'V', PMD32_LATENCY builds only
 
 // responses - PMD32 original
 #define PMD32_IDLE           0xAA // drive present
@@ -71,30 +73,110 @@
 #define TIMEOUT_SEND_ACK     500
 #define TIMEOUT_SEND_NAK     0
 
+#define DIRVIEW_IDLE_MS      1000 // host quiet for as long: sorted views listed without are built
+
+#ifdef PMD32_LATENCY
+// log2 histograms of command phases, timer 1 free running at 0.5us, millis() for 30ms and longer
+// bucket n: under 4us << n, the last one: all the rest
+#define LATENCY_BUCKETS      16
+#define LATENCY_CLASSES      5    // read, write, format or drive select, PMD32-SD extra, other
+#define LATENCY_PHASES       4    // arguments and CRC, SD I/O, result, payload
+#define LATENCY_TABLES       (LATENCY_CLASSES * LATENCY_PHASES + 4) // then whole commands per drive
+#define LATENCY_BAUD         115200
+
+#define LATENCY_MARK(stamp)  latencyMark(stamp)
+#define LATENCY_DRIVE(drive) m_latencyDrive = drive
+#else
+#define LATENCY_MARK(stamp)
+#define LATENCY_DRIVE(drive)
+#endif
+
 class PMD32
 {
 public: 
  
+  // running totals, wrapping; rates are taken from their differences
+  struct Stats
+  {
+    DWORD bytes;             // sector data transferred, either direction
+    WORD commands;
+    WORD naks;
+    WORD timeouts;           // within a command
+    WORD blockAccesses;      // 128B sector reads and writes
+    WORD blockHits;          // - || - within the SD block accessed just before, served by the SdFat cache
+    BYTE lastCommand;
+    BYTE driveWrites;        // bitmask, last access of the drive was a write
+    DWORD driveTime[4];      // millis() of the last access
+  };
+  
   PMD32();
   virtual ~PMD32() {};
   
   bool processCommand();
+  void processIdle();        // work deferred out of host commands
+  bool isHostIdle() const { return (millis() - m_commandTime) >= DIRVIEW_IDLE_MS; }
+  const Stats& getStats() const { return m_stats; }
+  
+#ifdef PMD32_LATENCY
+  void beginLatency();       // timer 1 and the serial port, once init() is done with them
+  void processSerial();      // 'h': histograms, as much per call as the serial buffer takes, 'r': reset
+#endif
   
 private:
 // PMD32
   BYTE m_CRC;
   bool m_hostResponding;
+  DWORD m_commandTime;       // millis() of the last command
   BYTE m_ioBuffer[512];
   
+  Stats m_stats;
+  bool m_inCommand;          // timeouts counted
+  BYTE m_lastDrive;          // last block accessed
+  DWORD m_lastBlock;
+  
   bool readByte(BYTE& data, DWORD timeout = TIMEOUT_READ, bool checkCRC = false);  
   bool sendByte(BYTE data, DWORD timeout = TIMEOUT_SEND);    
   void doRWOperation(bool write, bool format, bool readBootSector, WORD bytes);
   void changeDrive();
   void dummyCommand(BYTE inputArgumentsCount = 0, BYTE outputZerosCount = 1);
+  void sendNAK();
+  bool sendResult(BYTE data); // the phase boundaries around it are stamped
+  
+#ifdef PMD32_LATENCY
+  enum LatencyStamp
+  {
+    LatencyCommand = 0,      // command byte received
+    LatencyArguments,        // CRC acknowledged
+    LatencyIO,               // result known
+    LatencyResult,           // result sent
+    LatencyEnd               // payload sent
+  };
+  
+  WORD m_latency[LATENCY_TABLES][LATENCY_BUCKETS]; // saturating counts
+  WORD m_stampTicks[LatencyEnd + 1];
+  DWORD m_stampTime[LatencyEnd + 1];
+  BYTE m_stamped;            // bitmask of the above
+  BYTE m_latencyDrive;       // of the command, 0xFF: none
+  BYTE m_serialRow;          // next to print, 0xFF: not printing
+  BYTE m_serialColumn;       // of that row, the header line first on row 0
+  
+  void latencyMark(BYTE stamp);
+  void latencyRecord(BYTE table, BYTE from, BYTE to);
+  void latencyCommit(BYTE command);
+  void latencyReset();
+  void extraGetLatency();
+#endif
   
 // PMD32-SD extra
   File m_dirListing;
+  DirView m_dirView;        // sorted listing, if m_dirSorted
+  bool m_dirSorted;
+  bool m_dirViewWanted;     // m_cwdPath listed unsorted, no view built yet
+  WORD m_dirNext;
   BYTE m_cwdPath[64 + 1];
+  WORD m_findFirst;  // catalog search: sorted position of the first hit
+  WORD m_findCount;  //                 number of hits
+  WORD m_findNext;   //                 next one to send
   
   void extraSendMaxLengthString(BYTE maxLength, const char* str);
   void extraGetImagePath();
@@ -104,4 +186,5 @@ private:
   void extraChangeCurrentWorkingDirectory();
   void extraCreateImage();
   void extraImageInfo();
+  void extraFindImage();
 };
\ No newline at end of file
@@ -5,11 +5,12 @@
 #pragma once
 #include "config.h"
 
-// maximum number of characters for each string in PROGMEM, MAX+1 size of buffer for pgm_read_ptr()
+// maximum number of characters for each string in PROGMEM
 #define MAX_PROGMEM_STRING_LEN 32
 
 // bleh
 #define PROGMEM_DATA inline static const unsigned char
+#define PROGMEM_STRING(name) {name, sizeof(name) - 1}
 
 class Progmem
 {
@@ -24,6 +25,8 @@ public:
     uiNoCardPresent,
     uiUnsupportedFS,
     uiMountedDrives,
+    uiBootTimes,
+    uiArenaUsage,
     uiCardSafeToEject,
     uiMountQuestion,
     uiMountCaption,
@@ -36,8 +39,12 @@ public:
     uiPickerDetails,
     uiPickerRootDir,
     uiPickerOneLevelUp,
-    uiUpdatingEEPROM,
-    uiLoadingEEPROM,
+    uiFindCaption,
+    uiFindDriveQuestion,
+    uiFindQuestion,
+    uiFindPrompt,
+    uiFindNone,
+    uiFindIndexing,
     uiError,
     uiErrorMemory,
     uiErrorFS,
@@ -47,6 +54,10 @@ public:
     uiErrorFileCreate,
     uiErrorFileSize,
     uiBusy,
+    uiDashKBs,
+    uiDashNAKs,
+    uiDashTimeouts,
+    uiDashActivity,
     btnOK,
     btnCancel,
     btnYes,
@@ -64,19 +75,27 @@ public:
     btnDown,
     btnPgUp,
     btnPgDn,
-    btnOpen
+    btnOpen,
+    btnFind,
+    btnPrevChar,
+    btnNextChar,
+    btnAddChar,
+    btnDelChar
   };
   
-  // retrieve string from progmem, buffer valid until next call
-  static const char* getString(BYTE stringIndex)
-  {   
-    strncpy_P(m_strBuffer, pgm_read_ptr(&(m_stringTable[stringIndex])), MAX_PROGMEM_STRING_LEN);
-    return (const char*)&m_strBuffer[0];
+  // string in PROGMEM, read in place; its length is known at compile time
+  static PGM_P getString(::BYTE stringIndex)
+  {
+    return (PGM_P)pgm_read_ptr(&m_stringTable[stringIndex].text);
+  }
+  
+  static ::BYTE getLength(::BYTE stringIndex)
+  {
+    return pgm_read_byte(&m_stringTable[stringIndex].length);
   }
   
 // messages (definition order does not matter here). Length max MAX_PROGMEM_STRING_LEN
-// variadics can be loaded only one at a time from PROGMEM,
-// as only one buffer is used to transfer these between program space and our RAM
+// formats are expanded by UiText as they are drawn, never copied to RAM
 private:
   PROGMEM_DATA m_Empty[]              PROGMEM = "";
   PROGMEM_DATA m_uiTitle[]            PROGMEM = "PMD 32 / Mega2560";
@@ -84,6 +103,8 @@ private:
   PROGMEM_DATA m_uiNoCardPresent[]    PROGMEM = "No memory card recognized";
   PROGMEM_DATA m_uiUnsupportedFS[]    PROGMEM = "Must be FAT16/FAT32/exFAT on MBR";
   PROGMEM_DATA m_uiMountedDrives[]    PROGMEM = "%u mounted drive image(s)";
+  PROGMEM_DATA m_uiBootTimes[]        PROGMEM = "SD %u, A: %u, UI %u, all %u ms";
+  PROGMEM_DATA m_uiArenaUsage[]       PROGMEM = "Buffers: peak %u of %u bytes";
   PROGMEM_DATA m_uiCardSafeToEject[]  PROGMEM = "Memory card can now be ejected";
   PROGMEM_DATA m_uiMountQuestion[]    PROGMEM = "Which drive to mount?";
   PROGMEM_DATA m_uiMountCaption[]     PROGMEM = "Mount drive image";
@@ -93,11 +114,15 @@ private:
   PROGMEM_DATA m_uiCreateQuestion[]   PROGMEM = "Assign new image to drive:";
   PROGMEM_DATA m_uiCreateCaption[]    PROGMEM = "Create new image";
   PROGMEM_DATA m_uiCreateConfirm[]    PROGMEM = "Create and mount %s ?";
-  PROGMEM_DATA m_uiPickerDetails[]    PROGMEM = "Page %lu of %lu; Filter: *.p32";
+  PROGMEM_DATA m_uiPickerDetails[]    PROGMEM = "Page %lu of %s; Filter: *.p32";
   PROGMEM_DATA m_uiPickerRootDir[]    PROGMEM = "[.]";
   PROGMEM_DATA m_uiPickerOneLevelUp[] PROGMEM = "[..]";
-  PROGMEM_DATA m_uiUpdatingEEPROM[]   PROGMEM = "Updating EEPROM...";
-  PROGMEM_DATA m_uiLoadingEEPROM[]    PROGMEM = "Auto-mounting drives...";
+  PROGMEM_DATA m_uiFindCaption[]      PROGMEM = "Find image";
+  PROGMEM_DATA m_uiFindDriveQuestion[] PROGMEM = "Find image for which drive?";
+  PROGMEM_DATA m_uiFindQuestion[]     PROGMEM = "Image name starts with:";
+  PROGMEM_DATA m_uiFindPrompt[]       PROGMEM = "%s[%c]";
+  PROGMEM_DATA m_uiFindNone[]         PROGMEM = "No image found";
+  PROGMEM_DATA m_uiFindIndexing[]     PROGMEM = "Card is still being indexed";
   PROGMEM_DATA m_uiError[]            PROGMEM = "Error";
   PROGMEM_DATA m_uiErrorMemory[]      PROGMEM = "Memory allocation error";
   PROGMEM_DATA m_uiErrorFS[]          PROGMEM = "SD card filesystem error";
@@ -107,6 +132,10 @@ private:
   PROGMEM_DATA m_uiErrorFileCreate[]  PROGMEM = "Cannot create file";
   PROGMEM_DATA m_uiErrorFileSize[]    PROGMEM = "Invalid P32 - must be 360K";
   PROGMEM_DATA m_uiBusy[]             PROGMEM = "Busy...";
+  PROGMEM_DATA m_uiDashKBs[]          PROGMEM = "KB/s";
+  PROGMEM_DATA m_uiDashNAKs[]         PROGMEM = "NAK %u";
+  PROGMEM_DATA m_uiDashTimeouts[]     PROGMEM = "T/O %u";
+  PROGMEM_DATA m_uiDashActivity[]     PROGMEM = "%u cmd/s, hit %u%%, last %c";
   PROGMEM_DATA m_btnOK[]              PROGMEM = "OK";
   PROGMEM_DATA m_btnCancel[]          PROGMEM = "Cancel";
   PROGMEM_DATA m_btnYes[]             PROGMEM = "Yes";
@@ -125,33 +154,55 @@ private:
   PROGMEM_DATA m_btnPgUp[]            PROGMEM = "<<";
   PROGMEM_DATA m_btnPgDn[]            PROGMEM = ">>";
   PROGMEM_DATA m_btnOpen[]            PROGMEM = "Open";
+  PROGMEM_DATA m_btnFind[]            PROGMEM = "Find";
+  PROGMEM_DATA m_btnPrevChar[]        PROGMEM = "<";
+  PROGMEM_DATA m_btnNextChar[]        PROGMEM = ">";
+  PROGMEM_DATA m_btnAddChar[]         PROGMEM = "Add";
+  PROGMEM_DATA m_btnDelChar[]         PROGMEM = "Del";
+  
+// string table, with the lengths
+  struct String
+  {
+    const unsigned char* text;
+    ::BYTE length;
+  };
   
-// string table
-  PROGMEM_DATA* const m_stringTable[] PROGMEM = {  
-                                                  m_Empty,
-                                                  
-                                                  m_uiTitle,
-                                                  
-                                                  m_uiCardDetails, m_uiNoCardPresent, m_uiUnsupportedFS, m_uiMountedDrives,
-                                                  m_uiCardSafeToEject, m_uiMountQuestion, m_uiMountCaption, m_uiMountReadOnly,
-                                                  m_uiUnmountQuestion, m_uiUnmountCaption, m_uiCreateQuestion, m_uiCreateCaption,
-                                                  m_uiCreateConfirm,
-                                                  
-                                                  m_uiPickerDetails, m_uiPickerRootDir, m_uiPickerOneLevelUp,
-                                                  m_uiUpdatingEEPROM, m_uiLoadingEEPROM,
-                                                  m_uiError, m_uiErrorMemory, m_uiErrorFS, m_uiErrorPath, m_uiErrorFileOpen,
-                                                  m_uiErrorFileOpened, m_uiErrorFileCreate, m_uiErrorFileSize,
-                                                  
-                                                  m_uiBusy,
+  inline static const String m_stringTable[] PROGMEM = {
+                                                  PROGMEM_STRING(m_Empty),
 
-                                                  m_btnOK, m_btnCancel, m_btnYes, m_btnNo, m_btnBack, m_btnMount, 
-                                                  m_btnUnmount, m_btnCreate, m_btnEject, m_btnDriveA, m_btnDriveB,
-                                                  m_btnDriveC, m_btnDriveD, m_btnUp, m_btnDown, m_btnPgUp, m_btnPgDn, m_btnOpen
-                                                };
+                                                  PROGMEM_STRING(m_uiTitle),
+
+                                                  PROGMEM_STRING(m_uiCardDetails), PROGMEM_STRING(m_uiNoCardPresent),
+                                                  PROGMEM_STRING(m_uiUnsupportedFS), PROGMEM_STRING(m_uiMountedDrives),
+                                                  PROGMEM_STRING(m_uiBootTimes), PROGMEM_STRING(m_uiArenaUsage),
+                                                  PROGMEM_STRING(m_uiCardSafeToEject), PROGMEM_STRING(m_uiMountQuestion),
+                                                  PROGMEM_STRING(m_uiMountCaption), PROGMEM_STRING(m_uiMountReadOnly),
+                                                  PROGMEM_STRING(m_uiUnmountQuestion), PROGMEM_STRING(m_uiUnmountCaption),
+                                                  PROGMEM_STRING(m_uiCreateQuestion), PROGMEM_STRING(m_uiCreateCaption),
+                                                  PROGMEM_STRING(m_uiCreateConfirm),
 
-// provides for transfering messages between program space and our address space
-// even though we're in class Progmem, this is in RAM, not in PROGMEM itself
-  inline static unsigned char m_strBuffer[MAX_PROGMEM_STRING_LEN + 1];
+                                                  PROGMEM_STRING(m_uiPickerDetails), PROGMEM_STRING(m_uiPickerRootDir),
+                                                  PROGMEM_STRING(m_uiPickerOneLevelUp), PROGMEM_STRING(m_uiFindCaption),
+                                                  PROGMEM_STRING(m_uiFindDriveQuestion), PROGMEM_STRING(m_uiFindQuestion),
+                                                  PROGMEM_STRING(m_uiFindPrompt), PROGMEM_STRING(m_uiFindNone), PROGMEM_STRING(m_uiFindIndexing),
+                                                  PROGMEM_STRING(m_uiError), PROGMEM_STRING(m_uiErrorMemory), PROGMEM_STRING(m_uiErrorFS),
+                                                  PROGMEM_STRING(m_uiErrorPath), PROGMEM_STRING(m_uiErrorFileOpen),
+                                                  PROGMEM_STRING(m_uiErrorFileOpened), PROGMEM_STRING(m_uiErrorFileCreate),
+                                                  PROGMEM_STRING(m_uiErrorFileSize),
+
+                                                  PROGMEM_STRING(m_uiBusy), PROGMEM_STRING(m_uiDashKBs), PROGMEM_STRING(m_uiDashNAKs),
+                                                  PROGMEM_STRING(m_uiDashTimeouts), PROGMEM_STRING(m_uiDashActivity),
+
+                                                  PROGMEM_STRING(m_btnOK), PROGMEM_STRING(m_btnCancel), PROGMEM_STRING(m_btnYes),
+                                                  PROGMEM_STRING(m_btnNo), PROGMEM_STRING(m_btnBack), PROGMEM_STRING(m_btnMount),
+                                                  PROGMEM_STRING(m_btnUnmount), PROGMEM_STRING(m_btnCreate), PROGMEM_STRING(m_btnEject),
+                                                  PROGMEM_STRING(m_btnDriveA), PROGMEM_STRING(m_btnDriveB), PROGMEM_STRING(m_btnDriveC),
+                                                  PROGMEM_STRING(m_btnDriveD), PROGMEM_STRING(m_btnUp), PROGMEM_STRING(m_btnDown),
+                                                  PROGMEM_STRING(m_btnPgUp), PROGMEM_STRING(m_btnPgDn), PROGMEM_STRING(m_btnOpen),
+                                                  PROGMEM_STRING(m_btnFind), PROGMEM_STRING(m_btnPrevChar), PROGMEM_STRING(m_btnNextChar),
+                                                  PROGMEM_STRING(m_btnAddChar), PROGMEM_STRING(m_btnDelChar)
+                                                };
+  static_assert(sizeof(m_stringTable) / sizeof(m_stringTable[0]) == btnDelChar + 1, "m_stringTable out of sync");
   
 // 8x16 monospace "VGA" font
 private:
@@ -0,0 +1,52 @@
+// Mega2560 digital pins resolved to port registers and bits at compile time
+// for the touchscreen drivers, which switch them on every clock or sample
+
+#pragma once
+
+#include "Arduino.h"
+
+// digital pin (0..69) to port letter and bit, as in the core's pins_arduino.h
+#define FASTPIN_PORTS "EEEEGEHHHHBBBBJJHHDDDDAAAAAAAACCCCCCCCDGGGLLLLLLLLBBBBFFFFFFFFKKKKKKKK"
+#define FASTPIN_BITS  "0145533456456710103210012345677654321072107654321032100123456701234567"
+
+template <uint8_t pin>
+class FastPin {
+    public:
+        static const char port = FASTPIN_PORTS[pin];
+        static const uint8_t mask = 1 << (FASTPIN_BITS[pin] - '0');
+        static const bool memoryMapped = port >= 'H'; // lds/sts instead of sbi/cbi
+
+        static volatile uint8_t& out()
+        {
+            switch (port)
+            {
+                case 'A': return PORTA;
+                case 'B': return PORTB;
+                case 'C': return PORTC;
+                case 'D': return PORTD;
+                case 'E': return PORTE;
+                case 'F': return PORTF;
+                case 'G': return PORTG;
+                case 'H': return PORTH;
+                case 'J': return PORTJ;
+                case 'K': return PORTK;
+                default:  return PORTL;
+            }
+        }
+        static volatile uint8_t& dir() { return *(&out() - 1); } // DDRx, one below PORTx
+        static volatile uint8_t& in() { return *(&out() - 2); }  // PINx, two below
+
+        static void high() { out() |= mask; }
+        static void low() { out() &= ~mask; }
+        static bool read() { return in() & mask; }
+        static void output() { dir() |= mask; }
+        static void input() { dir() &= ~mask; }
+
+        // direction and level, to put a shared pin back as it was
+        static uint8_t save() { return ((dir() & mask) ? 2 : 0) | ((out() & mask) ? 1 : 0); }
+        static void restore(uint8_t state)
+        {
+            if (state & 1) high(); else low();
+            if (state & 2) output(); else input();
+        }
+};
@@ -59,6 +59,36 @@
 #define USING_16BIT_BUS 0
 #endif
 
+#if defined(MCUFRIEND_STATIC_ID)
+// controller known at build time: setRotation(), setAddrWindow() etc. test constants,
+// so the paths of other controllers and their cases in begin() are left out by the compiler
+#if MCUFRIEND_STATIC_ID == 0x9341
+#define STATIC_CAPABLE  (AUTO_READINC | MIPI_DCS_REV1 | MV_AXIS | READ_24BITS)
+#define RESET_LOW_MS    1           //ILI9341 tRW >= 10us
+#define RESET_READY_MS  5           //tRT
+#define SWRESET_MS      5           //before the next command
+#define SLEEPOUT_MIN_MS 115         //sleep out >= 120ms after a reset
+#define SLEEPOUT_MS     5           //before the next command
+#elif MCUFRIEND_STATIC_ID == 0x9595
+#define STATIC_CAPABLE  (REV_SCREEN | MIPI_DCS_REV1 | MV_AXIS)
+#else
+#error MCUFRIEND_STATIC_ID: 0x9341 or 0x9595, or take the capabilities of another one from begin()
+#endif
+#define LCD_ID          MCUFRIEND_STATIC_ID
+#define LCD_CAPABLE     STATIC_CAPABLE
+#else
+#define LCD_ID          _lcd_ID
+#define LCD_CAPABLE     _lcd_capable
+#endif
+
+#ifndef RESET_LOW_MS        //as autodetected
+#define RESET_LOW_MS    100
+#define RESET_READY_MS  100
+#define SWRESET_MS      150
+#define SLEEPOUT_MIN_MS 0
+#define SLEEPOUT_MS     150
+#endif
+
 MCUFRIEND_kbv::MCUFRIEND_kbv(int CS, int RS, int WR, int RD, int _RST):Adafruit_GFX(240, 320)
 {
     // we can not access GPIO pins until AHB has been enabled.
@@ -98,12 +128,16 @@ void MCUFRIEND_kbv::reset(void)
     RD_IDLE;
     WR_IDLE;
     RESET_IDLE;
+#if !defined(MCUFRIEND_STATIC_ID) || (MCUFRIEND_STATIC_ID != 0x9341)
     delay(50);
+#endif
     RESET_ACTIVE;
-    delay(100);
+    delay(RESET_LOW_MS);
     RESET_IDLE;
-    delay(100);
+    delay(RESET_READY_MS);
+#if !defined(MCUFRIEND_STATIC_ID) || (MCUFRIEND_STATIC_ID != 0x9341)
 	WriteCmdData(0xB0, 0x0000);   //R61520 needs this to read ID
+#endif
 }
 
 static void writecmddata(uint16_t cmd, uint16_t dat)
@@ -377,14 +411,14 @@ void MCUFRIEND_kbv::setRotation(uint8_t r)
         val = 0xF8;             //MY=1, MX=1, MV=1, ML=1, BGR=1
         break;
     }
-    if (_lcd_capable & INVERT_GS)
+    if (LCD_CAPABLE & INVERT_GS)
         val ^= 0x80;
-    if (_lcd_capable & INVERT_SS)
+    if (LCD_CAPABLE & INVERT_SS)
         val ^= 0x40;
-    if (_lcd_capable & INVERT_RGB)
+    if (LCD_CAPABLE & INVERT_RGB)
         val ^= 0x08;
-    if (_lcd_capable & MIPI_DCS_REV1) {
-        if (_lcd_ID == 0x6814) {  //.kbv my weird 0x9486 might be 68140
+    if (LCD_CAPABLE & MIPI_DCS_REV1) {
+        if (LCD_ID == 0x6814) {  //.kbv my weird 0x9486 might be 68140
             GS = (val & 0x80) ? (1 << 6) : 0;   //MY
             SS_v = (val & 0x40) ? (1 << 5) : 0;   //MX
             val &= 0x28;        //keep MV, BGR, MY=0, MX=0, ML=0
@@ -394,21 +428,21 @@ void MCUFRIEND_kbv::setRotation(uint8_t r)
             WriteCmdParamN(0xB6, 3, d);
             goto common_MC;
 #if !defined(OFFSET_9327)
-        } else if (_lcd_ID == 0x9327) {  //better 
+        } else if (LCD_ID == 0x9327) {  //better 
             d[0] = 0; 
             d[1] = (400 / 8) - 1;        //NL
             d[2] = (val & 0x80) ? (432 - 400) / 4 : 0; //SCN (SM=0)
             WriteCmdParamN(0xC0, 3, d);  //PANEL_DRV
             goto common_MC;
 #endif
-        } else if (_lcd_ID == 0x1963 || _lcd_ID == 0x9481 || _lcd_ID == 0x1511) {
+        } else if (LCD_ID == 0x1963 || LCD_ID == 0x9481 || LCD_ID == 0x1511) {
             if (val & 0x80)
                 val |= 0x01;    //GS
             if ((val & 0x40))
                 val |= 0x02;    //SS
-            if (_lcd_ID == 0x1963) val &= ~0xC0;
-            if (_lcd_ID == 0x9481) val &= ~0xD0;
-            if (_lcd_ID == 0x1511) {
+            if (LCD_ID == 0x1963) val &= ~0xC0;
+            if (LCD_ID == 0x9481) val &= ~0xD0;
+            if (LCD_ID == 0x1511) {
                 val &= ~0x10;   //remove ML
                 val |= 0xC0;    //force penguin 180 rotation
             }
@@ -416,13 +450,13 @@ void MCUFRIEND_kbv::setRotation(uint8_t r)
             goto common_MC;
         } else if (is8347) {
             _MC = 0x02, _MP = 0x06, _MW = 0x22, _SC = 0x02, _EC = 0x04, _SP = 0x06, _EP = 0x08;
-            if (_lcd_ID == 0x0065) {             //HX8352-B
+            if (LCD_ID == 0x0065) {             //HX8352-B
                 val |= 0x01;    //GS=1
                 if ((val & 0x10)) val ^= 0xD3;  //(ML) flip MY, MX, ML, SS, GS
                 if (r & 1) _MC = 0x82, _MP = 0x80;
                 else _MC = 0x80, _MP = 0x82;
             }
-            if (_lcd_ID == 0x5252) {             //HX8352-A
+            if (LCD_ID == 0x5252) {             //HX8352-A
                 val |= 0x02;   //VERT_SCROLLON
                 if ((val & 0x10)) val ^= 0xD4;  //(ML) flip MY, MX, SS. GS=1
             }
@@ -437,7 +471,7 @@ void MCUFRIEND_kbv::setRotation(uint8_t r)
     }
     // cope with 9320 variants
     else {
-        switch (_lcd_ID) {
+        switch (LCD_ID) {
 #if defined(SUPPORT_9225)
         case 0x9225:
             _SC = 0x37, _EC = 0x36, _SP = 0x39, _EP = 0x38;
@@ -463,7 +497,7 @@ void MCUFRIEND_kbv::setRotation(uint8_t r)
             GS = (val & 0x80) ? (1 << 9) : 0;
             SS_v = (val & 0x40) ? (1 << 8) : 0;
             // S6D0139 requires NL = 0x27,  S6D0154 NL = 0x28
-            WriteCmdData(0x01, GS | SS_v | ((_lcd_ID == 0x0139) ? 0x27 : 0x28));
+            WriteCmdData(0x01, GS | SS_v | ((LCD_ID == 0x0139) ? 0x27 : 0x28));
             goto common_ORG;
 #endif
         case 0x5420:
@@ -473,7 +507,7 @@ void MCUFRIEND_kbv::setRotation(uint8_t r)
             _MC = 0x200, _MP = 0x201, _MW = 0x202, _SC = 0x210, _EC = 0x211, _SP = 0x212, _EP = 0x213;
             GS = (val & 0x80) ? (1 << 15) : 0;
             NL = ((400 / 8) - 1) << 9;  // 400 rows
-            if (_lcd_ID == 0x9326 || _lcd_ID == 0x5420) { //NL and SCN are in diff position
+            if (LCD_ID == 0x9326 || LCD_ID == 0x5420) { //NL and SCN are in diff position
                 if (GS) GS |= (4 << 0);  //start SCN at row 32 PLEASE TEST ILI9326, SPFD5420
                 NL >>= 1;
             }
@@ -489,7 +523,7 @@ void MCUFRIEND_kbv::setRotation(uint8_t r)
           common_ORG:
             ORG = (val & 0x20) ? (1 << 3) : 0;
 #ifdef SUPPORT_8230
-            if (_lcd_ID == 0x8230) {    // UC8230 has strange BGR and READ_BGR behaviour
+            if (LCD_ID == 0x8230) {    // UC8230 has strange BGR and READ_BGR behaviour
                 if (rotation == 1 || rotation == 2) {
                     val ^= 0x08;        // change BGR bit for LANDSCAPE and PORTRAIT_REV
                 }
@@ -518,7 +552,7 @@ void MCUFRIEND_kbv::setRotation(uint8_t r)
 #endif
 		}
     }
-    if ((rotation & 1) && ((_lcd_capable & MV_AXIS) == 0)) {
+    if ((rotation & 1) && ((LCD_CAPABLE & MV_AXIS) == 0)) {
         uint16_t x;
         x = _MC, _MC = _MP, _MP = x;
         x = _SC, _SC = _SP, _SP = x;    //.kbv check 0139
@@ -545,22 +579,22 @@ void MCUFRIEND_kbv::drawPixel(int16_t x, int16_t y, uint16_t color)
 void MCUFRIEND_kbv::setAddrWindow(int16_t x, int16_t y, int16_t x1, int16_t y1)
 {
 #if defined(OFFSET_9327)
-	if (_lcd_ID == 0x9327) {
+	if (LCD_ID == 0x9327) {
 	    if (rotation == 2) y += OFFSET_9327, y1 += OFFSET_9327;
 	    if (rotation == 3) x += OFFSET_9327, x1 += OFFSET_9327;
     }
 #endif
 #if 1
-    if (_lcd_ID == 0x1526 && (rotation & 1)) {
+    if (LCD_ID == 0x1526 && (rotation & 1)) {
 		int16_t dx = x1 - x, dy = y1 - y;
 		if (dy == 0) { y1++; }
 		else if (dx == 0) { x1 += dy; y1 -= dy; }
     }
 #endif
-    if (_lcd_capable & MIPI_DCS_REV1) {
+    if (LCD_CAPABLE & MIPI_DCS_REV1) {
         WriteCmdParam4(_SC, x >> 8, x, x1 >> 8, x1);   //Start column instead of _MC
         WriteCmdParam4(_SP, y >> 8, y, y1 >> 8, y1);   //
-        if (is8347 && _lcd_ID == 0x0065) {             //HX8352-B has separate _MC, _SC
+        if (is8347 && LCD_ID == 0x0065) {             //HX8352-B has separate _MC, _SC
             uint8_t d[2];
             d[0] = x >> 8; d[1] = x;
             WriteCmdParamN(_MC, 2, d);                 //allows !MV_AXIS to work
@@ -571,7 +605,7 @@ void MCUFRIEND_kbv::setAddrWindow(int16_t x, int16_t y, int16_t x1, int16_t y1)
         WriteCmdData(_MC, x);
         WriteCmdData(_MP, y);
         if (!(x == x1 && y == y1)) {  //only need MC,MP for drawPixel
-            if (_lcd_capable & XSA_XEA_16BIT) {
+            if (LCD_CAPABLE & XSA_XEA_16BIT) {
                 if (rotation & 1)
                     y1 = y = (y1 << 8) | y;
                 else
@@ -585,6 +619,55 @@ void MCUFRIEND_kbv::setAddrWindow(int16_t x, int16_t y, int16_t x1, int16_t y1)
     }
 }
 
+#if !USING_16BIT_BUS && defined(BUS8_PUT)
+//8-bit shields with BUS8_ macros: a pixel whose two bytes match leaves the bus alone
+//and only strobes WR, otherwise the port images are stored as they are
+#define PIXEL8_SAME   { WR_STROBE8; WR_STROBE8; }
+#define PIXEL8(h, l)  { BUS8_PUT(h); WR_STROBE8; BUS8_PUT(l); WR_STROBE8; }
+
+static void fill8(uint8_t hi, uint8_t lo, uint16_t n)
+{
+    uint8_t tail = n & 7;
+    n >>= 3;
+    if (hi == lo) {             //black and white
+        BUS8_DECLARE(b);
+        BUS8_PREP(b, hi);
+        BUS8_PUT(b);
+        while (n-- > 0) {
+            PIXEL8_SAME;
+            PIXEL8_SAME;
+            PIXEL8_SAME;
+            PIXEL8_SAME;
+            PIXEL8_SAME;
+            PIXEL8_SAME;
+            PIXEL8_SAME;
+            PIXEL8_SAME;
+        }
+        while (tail-- > 0) {
+            PIXEL8_SAME;
+        }
+    } else {
+        BUS8_DECLARE(h);
+        BUS8_DECLARE(l);
+        BUS8_PREP(h, hi);
+        BUS8_PREP(l, lo);
+        while (n-- > 0) {
+            PIXEL8(h, l);
+            PIXEL8(h, l);
+            PIXEL8(h, l);
+            PIXEL8(h, l);
+            PIXEL8(h, l);
+            PIXEL8(h, l);
+            PIXEL8(h, l);
+            PIXEL8(h, l);
+        }
+        while (tail-- > 0) {
+            PIXEL8(h, l);
+        }
+    }
+}
+#endif
+
 void MCUFRIEND_kbv::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 {
     int16_t end;
@@ -662,17 +745,155 @@ void MCUFRIEND_kbv::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_
              } while (--end != 0);
         } else
 #endif
+#if defined(BUS8_PUT)
+        fill8(hi, lo, end);
+#else
         do {
             write8(hi);
             write8(lo);
         } while (--end != 0);
+#endif
 #endif
     }
     CS_IDLE;
-    if (!(_lcd_capable & MIPI_DCS_REV1) || ((_lcd_ID == 0x1526) && (rotation & 1)))
+    if (!(LCD_CAPABLE & MIPI_DCS_REV1) || ((LCD_ID == 0x1526) && (rotation & 1)))
         setAddrWindow(0, 0, width() - 1, height() - 1);
 }
 
+void MCUFRIEND_kbv::pushRun(uint16_t color, uint16_t n, bool first)
+{
+    // n pixels of one color into the window set, as fillRect() does without a window of its own
+    uint8_t lo;
+#if defined(SUPPORT_9488_555)
+    if (is555) color = color565_to_555(color);
+#endif
+    CS_ACTIVE;
+    if (first) {
+        WriteCmd(_MW);
+    }
+    if (n) {
+#if USING_16BIT_BUS
+        write_16(color);
+        lo = n & 7;
+        n >>= 3;
+        while (n-- > 0) {
+            STROBE_16BIT;
+            STROBE_16BIT;
+            STROBE_16BIT;
+            STROBE_16BIT;
+            STROBE_16BIT;
+            STROBE_16BIT;
+            STROBE_16BIT;
+            STROBE_16BIT;
+        }
+        while (lo-- > 0) {
+            STROBE_16BIT;
+        }
+#else
+        uint8_t hi = color >> 8;
+        lo = color & 0xFF;
+#if defined(SUPPORT_1289) || defined(SUPPORT_1963)
+        if (is9797) {
+             uint8_t r = color565_to_r(color);
+             uint8_t g = color565_to_g(color);
+             uint8_t b = color565_to_b(color);
+             do {
+                 write8(r);
+                 write8(g);
+                 write8(b);
+             } while (--n != 0);
+        } else
+#endif
+#if defined(BUS8_PUT)
+        fill8(hi, lo, n);
+#else
+        do {
+            write8(hi);
+            write8(lo);
+        } while (--n != 0);
+#endif
+#endif
+    }
+    CS_IDLE;
+}
+
+void MCUFRIEND_kbv::pushBits(const uint8_t * bits, int16_t n, uint16_t fg, uint16_t bg, bool first)
+{
+    // n pixels from a 1bpp bitmap, MSB first: set bits in fg, clear ones in bg
+    // a pixel the same as the one before only strobes WR if the bus still holds it
+    uint8_t mask = 0, b = 0, on, bus = 2;
+#if defined(SUPPORT_9488_555)
+    if (is555) {
+        fg = color565_to_555(fg);
+        bg = color565_to_555(bg);
+    }
+#endif
+    CS_ACTIVE;
+    if (first) {
+        WriteCmd(_MW);
+    }
+#if USING_16BIT_BUS
+    if (!is9797) {
+        while (n-- > 0) {
+            if (!mask) {
+                b = *bits++;
+                mask = 0x80;
+            }
+            on = (b & mask) != 0;
+            mask >>= 1;
+            if (on != bus) {
+                write_16(on ? fg : bg);
+                bus = on;
+            }
+            STROBE_16BIT;
+        }
+    } else
+#elif defined(BUS8_PUT)
+    if (!is9797) {
+        uint8_t fgSame = (fg >> 8) == (fg & 0xFF) ? 1 : 2;   //bus state after fg: 1 if its bytes match
+        uint8_t bgSame = (bg >> 8) == (bg & 0xFF) ? 0 : 2;
+        BUS8_DECLARE(fh);
+        BUS8_DECLARE(fl);
+        BUS8_DECLARE(bh);
+        BUS8_DECLARE(bl);
+        BUS8_PREP(fh, fg >> 8);
+        BUS8_PREP(fl, fg & 0xFF);
+        BUS8_PREP(bh, bg >> 8);
+        BUS8_PREP(bl, bg & 0xFF);
+        while (n-- > 0) {
+            if (!mask) {
+                b = *bits++;
+                mask = 0x80;
+            }
+            on = (b & mask) != 0;
+            mask >>= 1;
+            if (on == bus) {
+                PIXEL8_SAME;
+            } else if (on) {
+                PIXEL8(fh, fl);
+                bus = fgSame;
+            } else {
+                PIXEL8(bh, bl);
+                bus = bgSame;
+            }
+        }
+    } else
+#endif
+    {
+        while (n-- > 0) {
+            if (!mask) {
+                b = *bits++;
+                mask = 0x80;
+            }
+            on = b & mask;
+            mask >>= 1;
+            if (is9797) write24(on ? fg : bg); else
+            write16(on ? fg : bg);
+        }
+    }
+    CS_IDLE;
+}
+
 static void pushColors_any(uint16_t cmd, uint8_t * block, int16_t n, bool first, uint8_t flags)
 {
     uint16_t color;
@@ -726,23 +947,23 @@ void MCUFRIEND_kbv::pushColors(const uint8_t * block, int16_t n, bool first, boo
 void MCUFRIEND_kbv::vertScroll(int16_t top, int16_t scrollines, int16_t offset)
 {
 #if defined(OFFSET_9327)
-	if (_lcd_ID == 0x9327) {
+	if (LCD_ID == 0x9327) {
 	    if (rotation == 2 || rotation == 3) top += OFFSET_9327;
     }
 #endif
     int16_t bfa = HEIGHT - top - scrollines;  // bottom fixed area
     int16_t vsp;
     int16_t sea = top;
-	if (_lcd_ID == 0x9327) bfa += 32;
+	if (LCD_ID == 0x9327) bfa += 32;
     if (offset <= -scrollines || offset >= scrollines) offset = 0; //valid scroll
 	vsp = top + offset; // vertical start position
     if (offset < 0)
         vsp += scrollines;          //keep in unsigned range
     sea = top + scrollines - 1;
-    if (_lcd_capable & MIPI_DCS_REV1) {
+    if (LCD_CAPABLE & MIPI_DCS_REV1) {
         uint8_t d[6];           // for multi-byte parameters
 /*
-        if (_lcd_ID == 0x9327) {        //panel is wired for 240x432 
+        if (LCD_ID == 0x9327) {        //panel is wired for 240x432 
             if (rotation == 2 || rotation == 3) { //180 or 270 degrees
                 if (scrollines == HEIGHT) {
                     scrollines = 432;   // we get a glitch but hey-ho
@@ -766,15 +987,15 @@ void MCUFRIEND_kbv::vertScroll(int16_t top, int16_t scrollines, int16_t offset)
         d[1] = vsp;
         WriteCmdParamN(is8347 ? 0x14 : 0x37, 2, d);
 		if (is8347) { 
-		    d[0] = (offset != 0) ? (_lcd_ID == 0x8347 ? 0x02 : 0x08) : 0;
-			WriteCmdParamN(_lcd_ID == 0x8347 ? 0x18 : 0x01, 1, d);  //HX8347-D
-		} else if (offset == 0 && (_lcd_capable & MIPI_DCS_REV1)) {
+		    d[0] = (offset != 0) ? (LCD_ID == 0x8347 ? 0x02 : 0x08) : 0;
+			WriteCmdParamN(LCD_ID == 0x8347 ? 0x18 : 0x01, 1, d);  //HX8347-D
+		} else if (offset == 0 && (LCD_CAPABLE & MIPI_DCS_REV1)) {
 			WriteCmdParamN(0x13, 0, NULL);    //NORMAL i.e. disable scroll
 		}
 		return;
     }
     // cope with 9320 style variants:
-    switch (_lcd_ID) {
+    switch (LCD_ID) {
     case 0x7783:
         WriteCmdData(0x61, _lcd_rev);   //!NDL, !VLE, REV
         WriteCmdData(0x6A, vsp);        //VL#
@@ -816,12 +1037,12 @@ void MCUFRIEND_kbv::vertScroll(int16_t top, int16_t scrollines, int16_t offset)
 void MCUFRIEND_kbv::invertDisplay(bool i)
 {
     uint8_t val;
-    _lcd_rev = ((_lcd_capable & REV_SCREEN) != 0) ^ i;
-    if (_lcd_capable & MIPI_DCS_REV1) {
+    _lcd_rev = ((LCD_CAPABLE & REV_SCREEN) != 0) ^ i;
+    if (LCD_CAPABLE & MIPI_DCS_REV1) {
         if (is8347) {
             // HX8347D: 0x36 Panel Characteristic. REV_Panel
             // HX8347A: 0x36 is Display Control 10
-            if (_lcd_ID == 0x8347 || _lcd_ID == 0x5252) // HX8347-A, HX5352-A
+            if (LCD_ID == 0x8347 || LCD_ID == 0x5252) // HX8347-A, HX5352-A
 			    val = _lcd_rev ? 6 : 2;       //INVON id bit#2,  NORON=bit#1
             else val = _lcd_rev ? 8 : 10;     //HX8347-D, G, I: SCROLLON=bit3, INVON=bit1
             // HX8347: 0x01 Display Mode has diff bit mapping for A, D 
@@ -831,7 +1052,7 @@ void MCUFRIEND_kbv::invertDisplay(bool i)
         return;
     }
     // cope with 9320 style variants:
-    switch (_lcd_ID) {
+    switch (LCD_ID) {
 #ifdef SUPPORT_0139
     case 0x0139:
 #endif
@@ -913,6 +1134,9 @@ void MCUFRIEND_kbv::begin(uint16_t ID)
     int16_t table_size;
     reset();
     _lcd_xor = 0;
+#if defined(MCUFRIEND_STATIC_ID)
+    ID = MCUFRIEND_STATIC_ID;   //the switch is folded to its case
+#endif
     switch (_lcd_ID = ID) {
 /*
 	static const uint16_t _regValues[] PROGMEM = {
@@ -3056,27 +3280,30 @@ case 0x4532:    // thanks Leodino
         *p16 = 0;       //error value for WIDTH
         break;
     }
-    _lcd_rev = ((_lcd_capable & REV_SCREEN) != 0);
+    _lcd_rev = ((LCD_CAPABLE & REV_SCREEN) != 0);
     if (table8_ads != NULL) {
         static const uint8_t reset_off[] PROGMEM = {
             0x01, 0,            //Soft Reset
-            TFTLCD_DELAY8, 150,  // .kbv will power up with ONLY reset, sleep out, display on
+            TFTLCD_DELAY8, SWRESET_MS,  // .kbv will power up with ONLY reset, sleep out, display on
             0x28, 0,            //Display Off
             0x3A, 1, 0x55,      //Pixel read=565, write=565.
         };
         static const uint8_t wake_on[] PROGMEM = {
 			0x11, 0,            //Sleep Out
-            TFTLCD_DELAY8, 150,
+            TFTLCD_DELAY8, SLEEPOUT_MS,
             0x29, 0,            //Display On
         };
+		uint32_t swreset = millis();
 		init_table(&reset_off, sizeof(reset_off));
 	    init_table(table8_ads, table_size);   //can change PIXFMT
+		while ((millis() - swreset) < SLEEPOUT_MIN_MS + SWRESET_MS)
+			yield();            //as delay() does
 		init_table(&wake_on, sizeof(wake_on));
     }
     setRotation(0);             //PORTRAIT
     invertDisplay(false);
 #if defined(SUPPORT_9488_555)
-    if (_lcd_ID == 0x9488) {
+    if (LCD_ID == 0x9488) {
 		is555 = 0;
 		drawPixel(0, 0, 0xFFE0);
 		if (readPixel(0, 0) == 0xFF1F) {
@@ -42,6 +42,8 @@ class MCUFRIEND_kbv : public Adafruit_GFX {
 	void     pushColors(uint16_t *block, int16_t n, bool first);
 	void     pushColors(uint8_t *block, int16_t n, bool first);
 	void     pushColors(const uint8_t *block, int16_t n, bool first, bool bigend = false);
+	void     pushRun(uint16_t color, uint16_t n, bool first);         // n pixels of one color
+	void     pushBits(const uint8_t *bits, int16_t n, uint16_t fg, uint16_t bg, bool first); // 1bpp in two colors
     void     vertScroll(int16_t top, int16_t scrollines, int16_t offset);
 
     protected:
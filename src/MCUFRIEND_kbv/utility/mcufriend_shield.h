@@ -90,6 +90,13 @@
 #define write16(x)    { uint8_t h = (x)>>8, l = x; write8(h); write8(l); }
 #define READ_8(dst)   { RD_STROBE; dst = read_8(); RD_IDLE; }
 #define READ_16(dst)  { uint8_t hi; READ_8(hi); READ_8(dst); dst |= (hi << 8); }
+// fill kernels: the three port images of a byte worked out once per run, then stored without read-modify-write
+#define WR_STROBE8    WR_STROBE
+#define BUS8_DECLARE(v) uint8_t v##H, v##E, v##G
+#define BUS8_PREP(v, x) { v##H = (PORTH & ~HMASK) | (((x) & (3<<0)) << 5) | (((x) & (3<<6)) >> 3); \
+                          v##E = (PORTE & ~EMASK) | (((x) & (3<<2)) << 2) | (((x) & (1<<5)) >> 2); \
+                          v##G = (PORTG & ~GMASK) | (((x) & (1<<4)) << 1); }
+#define BUS8_PUT(v)   { PORTH = v##H; PORTE = v##E; PORTG = v##G; }
 
 #define PIN_LOW(p, b)        (p) &= ~(1<<(b))
 #define PIN_HIGH(p, b)       (p) |= (1<<(b))
@@ -22,6 +22,13 @@
 //#define USE_CURIOSITY_AVR128DA48
 //#define USE_CURIOSITY_AVR128DB48
 
+// 16-bit shields are write only, their controller is not autodetected:
+// with its ID here (0x9341 or 0x9595), only its init and paths are built, with datasheet delays
+// must match DISP_ID_16BIT in config.h, comment out to build all controllers
+#if defined(USE_MEGA_16BIT_SHIELD)
+#define MCUFRIEND_STATIC_ID 0x9341
+#endif
+
 
 /*
 HX8347A  tWC =100ns  tWRH = 35ns  tRCFM = 450ns  tRC = ?  ns
@@ -0,0 +1,126 @@
+// Passive (4-wire resistive) touchscreen sampled through the port and ADC registers,
+// returns Adafruit TSPoint like TouchScreen::getPoint(): x, y 0..1023, z > 0 if touched,
+// z = TSF_NO_SAMPLE if touched but the position was rejected (neither a touch nor a release)
+
+#pragma once
+
+#include "Arduino.h"
+#include "TouchScreen.h"
+#include "../FastPin/FastPin.h"
+
+#define TSF_PRESCALE   (_BV(ADPS2))  // ADC clock 16MHz/16 = 1MHz, 13us per conversion (core: /128, 104us)
+#define TSF_SETTLE     2             // conversions dropped after switching the channel or the plates
+#define TSF_SAMPLES    4             // averaged per axis
+#define TSF_SPREAD     16            // samples of an axis further apart than this: finger moving or lifting, rejected
+#define TSF_Z_MIN      64            // pressure below this: not touched, X and Y are not read
+#define TSF_NO_SAMPLE  -1            // z of a rejected reading
+
+template <uint8_t xp, uint8_t yp, uint8_t xm, uint8_t ym>
+class TouchScreen_Fast {
+    public:
+        TSPoint getPoint()
+        {
+            // the plates are shared with the TFT bus: as they were when done
+            const uint8_t savedXP = XP::save();
+            const uint8_t savedYP = YP::save();
+            const uint8_t savedXM = XM::save();
+            const uint8_t savedYM = YM::save();
+            const uint8_t savedADCSRA = ADCSRA;
+            const uint8_t savedADCSRB = ADCSRB;
+            const uint8_t savedADMUX = ADMUX;
+
+            // pressure first: XP low, YM high, the other two read
+            XP::output(); XP::low();
+            YM::output(); YM::high();
+            XM::input(); XM::low();
+            YP::input(); YP::low();
+            ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIF) | TSF_PRESCALE; // free running
+            channel(XM_CHANNEL);
+            const int16_t z1 = conversion();
+            channel(YP_CHANNEL);
+            const int16_t z2 = conversion();
+            int16_t z = 1023 - (z2 - z1);
+
+            int16_t x = 0;
+            int16_t y = 0;
+            if (z < TSF_Z_MIN)
+            {
+                z = 0;
+            }
+            else
+            {
+                // X: across XP-XM, read on YP
+                YM::input(); YM::low();
+                XM::output();
+                XP::high();
+                x = average(YP_CHANNEL);
+
+                // Y: across YP-YM, read on XM
+                XP::input(); XP::low();
+                XM::input();
+                YP::output(); YP::high();
+                YM::output();
+                y = average(XM_CHANNEL);
+
+                if ((x < 0) || (y < 0))
+                {
+                    z = TSF_NO_SAMPLE;
+                }
+                x = 1023 - x;
+                y = 1023 - y;
+            }
+
+            ADCSRA = savedADCSRA & ~_BV(ADATE);
+            ADCSRB = savedADCSRB;
+            ADMUX = savedADMUX;
+            XP::restore(savedXP);
+            YP::restore(savedYP);
+            XM::restore(savedXM);
+            YM::restore(savedYM);
+
+            return TSPoint(x, y, z);
+        }
+
+    private:
+        typedef FastPin<xp> XP;
+        typedef FastPin<yp> YP;
+        typedef FastPin<xm> XM;
+        typedef FastPin<ym> YM;
+        static const uint8_t YP_CHANNEL = yp - A0; // YP and XM are analog pins
+        static const uint8_t XM_CHANNEL = xm - A0;
+
+        static void channel(uint8_t ch)
+        {
+            // AVcc reference as the core's DEFAULT; the conversion running still reads the old channel
+            ADMUX = _BV(REFS0) | (ch & 7);
+            ADCSRB = (ch & 8) ? _BV(MUX5) : 0;
+            for (uint8_t drop = 0; drop < TSF_SETTLE; drop++)
+            {
+                conversion();
+            }
+        }
+
+        static int16_t conversion()
+        {
+            while (!(ADCSRA & _BV(ADIF)));
+            ADCSRA |= _BV(ADIF);
+            return ADC;
+        }
+
+        static int16_t average(uint8_t ch)
+        {
+            // oversampled, -1 if too spread out
+            channel(ch);
+            int16_t sum = 0;
+            int16_t low = 1023;
+            int16_t high = 0;
+            for (uint8_t at = 0; at < TSF_SAMPLES; at++)
+            {
+                const int16_t value = conversion();
+                sum += value;
+                low = (value < low) ? value : low;
+                high = (value > high) ? value : high;
+            }
+            return ((high - low) > TSF_SPREAD) ? -1 : (sum / TSF_SAMPLES);
+        }
+};
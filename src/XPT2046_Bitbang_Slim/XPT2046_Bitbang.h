@@ -1,29 +1,124 @@
 // C. Näveke's XPT2046 implementation adapted to output Adafruit TSPoint
+// pins resolved to Mega2560 port bits at compile time, clocked at the datasheet minimum timing
 
 #pragma once
 
 #include "Arduino.h"
 #include "TouchScreen.h"
+#include "../FastPin/FastPin.h"
 
 #define CMD_READ_X   0x91 // Command for XPT2046 to read X position
 #define CMD_READ_Y   0xD1 // Command for XPT2046 to read Y position
 #define CMD_READ_Z1  0xB1 // Command for XPT2046 to read Z1 position
 #define CMD_READ_Z2  0xC1 // Command for XPT2046 to read Z2 position
 
-#define DELAY 5
+#define Z1_IDLE      10   // Z1 at or below this: panel not touched, Z2, X and Y are not read
+#define Z_MIN        100  // pressure below this: not touched
 
+// DCLK high and low are 200ns minimum (tCH, tCL), 4 cycles at 16MHz;
+// sbi/cbi on the lower ports take 2, the lds/sts on ports H-L take that already
+#if defined(__AVR_ARCH__)
+#define XPT_WAIT(cycles) __builtin_avr_delay_cycles(cycles)
+#else
+#define XPT_WAIT(cycles)
+#endif
+
+template <uint8_t mosiPin, uint8_t misoPin, uint8_t clkPin, uint8_t csPin>
 class XPT2046_Bitbang {
     public:
-        XPT2046_Bitbang(uint8_t mosiPin, uint8_t misoPin, uint8_t clkPin, uint8_t csPin);
-        void beginXPT();
-        TSPoint getPoint();
+        XPT2046_Bitbang()
+        {
+            beginXPT();
+        }
+
+        void beginXPT()
+        {
+            pinMode(mosiPin, OUTPUT);
+            pinMode(misoPin, INPUT);
+            pinMode(clkPin, OUTPUT);
+            pinMode(csPin, OUTPUT);
+            CS::high();
+            CLK::low();
+        }
+
+        TSPoint getPoint()
+        {
+            CS::low(); // tCSS 100ns: the command's first DIN write comes before DCLK rises
+
+            uint16_t z1 = readSPI(CMD_READ_Z1);
+            if (z1 <= Z1_IDLE)
+            {
+                CS::high();
+                return TSPoint{0, 0, 0};
+            }
+
+            uint16_t z = z1 + 4095;
+            uint16_t z2 = readSPI(CMD_READ_Z2);
+            z -= z2;
+
+            if (z < Z_MIN)
+            {
+                CS::high();
+                return TSPoint{0, 0, 0};
+            }
+
+            // convert to Adafruit TSPoint (0..1023)
+            uint16_t xRaw = readSPI(CMD_READ_X);
+            uint16_t yRaw = 4095 - readSPI(CMD_READ_Y & ~((byte)1));
+            CS::high();
+            uint16_t y = xRaw >> 2;
+            uint16_t x = yRaw >> 2;
+
+            return TSPoint{x, y, z};
+        }
 
     private:
-        uint8_t _mosiPin;
-        uint8_t _misoPin;
-        uint8_t _clkPin;
-        uint8_t _csPin;
-        void writeSPI(byte command);
-        uint16_t readSPI(byte command);
-};
+        typedef FastPin<mosiPin> DIN;
+        typedef FastPin<misoPin> DOUT;
+        typedef FastPin<clkPin> CLK;
+        typedef FastPin<csPin> CS;
+        static const uint8_t CLK_WAIT = CLK::memoryMapped ? 0 : 2;
+
+        static void writeSPI(byte command)
+        {
+            // DIN latched on the rising DCLK edge
+            for (byte bit = 0x80; bit; bit >>= 1)
+            {
+                if (command & bit)
+                {
+                    DIN::high();
+                }
+                else
+                {
+                    DIN::low();
+                }
+                CLK::high();
+                XPT_WAIT(CLK_WAIT);
+                CLK::low();
+                XPT_WAIT(CLK_WAIT);
+            }
+            DIN::low();
+        }
 
+        static uint16_t readSPI(byte command)
+        {
+            writeSPI(command);
+
+            // 16 clocks, DOUT valid 200ns (tDO) after the falling edge, 12 bits MSB first
+            uint16_t result = 0;
+            for (byte i = 0; i < 16; i++)
+            {
+                CLK::high();
+                XPT_WAIT(CLK_WAIT);
+                CLK::low();
+                XPT_WAIT(CLK_WAIT + 2);
+                result <<= 1;
+                if (DOUT::read())
+                {
+                    result |= 1;
+                }
+            }
+
+            return result >> 4;
+        }
+};
@@ -0,0 +1,264 @@
+// PMD32-Mega2560 (c) 2025 J. Bogin, https://boginjr.com
+// Based on PMD32-SD (c) 2012 R. Borik, https://pmd85.borik.net/
+// Touchscreen sampling
+
+#include "config.h"
+
+// calibration record at TOUCH_CAL_EEPROM:
+// +0, 1:  TOUCH_CAL_MAGIC
+// +1, 24: matrix of setRotation(1), 6x int32 (16.16)
+// +25, 2: CRC16 of all the above
+
+void Touch::loadCalibration()
+{
+  WORD crc = 0xFFFF;
+  BYTE* data = (BYTE*)m_cal;
+  for (BYTE index = 0; index < 1 + sizeof(m_cal); index++)
+  {
+    const BYTE value = EEPROM.read(TOUCH_CAL_EEPROM + index);
+    crc = _crc16_update(crc, value);
+    if (index)
+    {
+      data[index - 1] = value;
+    }
+  }
+
+  const WORD stored = EEPROM.read(TOUCH_CAL_EEPROM + 1 + sizeof(m_cal)) |
+                      (EEPROM.read(TOUCH_CAL_EEPROM + 2 + sizeof(m_cal)) << 8);
+  if ((EEPROM.read(TOUCH_CAL_EEPROM) != TOUCH_CAL_MAGIC) || (crc != stored))
+  {
+    // the build's: x from raw.y, y from raw.x, both scaled between the calibrated edges
+    m_cal[0] = 0;
+    m_cal[1] = ((int32_t)DISP_WIDTH << 16) / (TOUCH_CAL_X2 - TOUCH_CAL_X1);
+    m_cal[2] = -TOUCH_CAL_X1 * m_cal[1];
+    m_cal[3] = ((int32_t)DISP_HEIGHT << 16) / (TOUCH_CAL_Y2 - TOUCH_CAL_Y1);
+    m_cal[4] = 0;
+    m_cal[5] = -TOUCH_CAL_Y1 * m_cal[3];
+  }
+
+#ifdef DISP_FLIP_ORIENTATION
+  flipCalibration(m_cal);
+#endif
+}
+
+void Touch::storeCalibration(const int32_t* matrix)
+{
+  WORD crc = _crc16_update(0xFFFF, TOUCH_CAL_MAGIC);
+  EEPROM.update(TOUCH_CAL_EEPROM, TOUCH_CAL_MAGIC);
+
+  const BYTE* data = (const BYTE*)matrix;
+  for (BYTE index = 0; index < sizeof(m_cal); index++)
+  {
+    crc = _crc16_update(crc, data[index]);
+    EEPROM.update(TOUCH_CAL_EEPROM + 1 + index, data[index]);
+  }
+
+  EEPROM.update(TOUCH_CAL_EEPROM + 1 + sizeof(m_cal), crc & 0xFF);
+  EEPROM.update(TOUCH_CAL_EEPROM + 2 + sizeof(m_cal), crc >> 8);
+}
+
+void Touch::flipCalibration(int32_t* matrix)
+{
+  // rotated by 180 degrees: x' = DISP_WIDTH - x, y' = DISP_HEIGHT - y
+  for (BYTE index = 0; index < 6; index++)
+  {
+    matrix[index] = -matrix[index];
+  }
+  matrix[2] += (int32_t)DISP_WIDTH << 16;
+  matrix[5] += (int32_t)DISP_HEIGHT << 16;
+}
+
+#ifndef TOUCH_SCREEN_CALIBRATION
+
+Touch* touchSampled = NULL;     // sampled from the timer once begun
+
+int16_t touchMedian(const int16_t* values)
+{
+  // of three
+  const int16_t low = (values[0] < values[1]) ? values[0] : values[1];
+  const int16_t high = (values[0] < values[1]) ? values[1] : values[0];
+  return (values[2] < low) ? low : (values[2] > high) ? high : values[2];
+}
+
+void Touch::begin()
+{
+  m_rawAt = 0;
+  m_touched = 0;
+  m_untouched = 0;
+  m_pressed = false;
+  m_sampleTime = millis();
+  m_eventHead = 0;
+  m_eventTail = 0;
+  loadCalibration();
+
+#ifdef TOUCH_SCREEN_ACTIVE
+  // compare match A fires once per timer 0 overflow too, away from it
+  // (OCR0A is the PWM of pin 13, analogWrite() there would take it back)
+  touchSampled = this;
+  OCR0A = 0x80;
+  TIMSK0 |= _BV(OCIE0A);
+#endif
+}
+
+void Touch::poll()
+{
+#ifndef TOUCH_SCREEN_ACTIVE
+  const DWORD now = millis();
+  if ((now - m_sampleTime) >= TOUCH_SAMPLE_MS)
+  {
+    m_sampleTime = now;
+    sample();
+  }
+#endif
+}
+
+bool Touch::getEvent(TouchEvent& event)
+{
+  // the timer may be queuing meanwhile
+  const BYTE sreg = SREG;
+  cli();
+  const bool available = m_eventTail != m_eventHead;
+  if (available)
+  {
+    event = m_events[m_eventTail];
+    m_eventTail = (m_eventTail + 1) & (TOUCH_EVENTS - 1);
+  }
+  SREG = sreg;
+
+  return available;
+}
+
+void Touch::flushEvents()
+{
+  const BYTE sreg = SREG;
+  cli();
+  m_eventTail = m_eventHead;
+  SREG = sreg;
+}
+
+void Touch::pushEvent(BYTE type, DWORD time)
+{
+  // a move not picked up yet is updated in place, full queue: the oldest goes
+  const BYTE head = m_eventHead;
+  const BYTE newest = (head - 1) & (TOUCH_EVENTS - 1);
+  TouchEvent* event = &m_events[head];
+
+  if ((type == TouchMove) && (head != m_eventTail) && (m_events[newest].type == TouchMove))
+  {
+    event = &m_events[newest];
+  }
+  else
+  {
+    m_eventHead = (head + 1) & (TOUCH_EVENTS - 1);
+    if (m_eventHead == m_eventTail)
+    {
+      m_eventTail = (m_eventTail + 1) & (TOUCH_EVENTS - 1);
+    }
+  }
+
+  event->type = type;
+  event->x = m_eventX;
+  event->y = m_eventY;
+  event->time = time;
+}
+
+void Touch::sample()
+{
+  const TSPoint raw = getPointRaw();
+  const DWORD now = millis();
+
+  // reading rejected while touched (passive, TSF_NO_SAMPLE): skipped, the press goes on
+  if (raw.z < 0)
+  {
+    return;
+  }
+
+  if (!raw.z)
+  {
+    m_touched = 0;
+    if (m_pressed && !m_untouched++)
+    {
+      m_untouchedTime = now;
+    }
+
+    // released where it was last seen
+    if (m_pressed && (m_untouched >= TOUCH_RELEASE_COUNT))
+    {
+      m_pressed = false;
+      pushEvent(TouchRelease, m_untouchedTime);
+    }
+    return;
+  }
+
+  // first touched sample fills the median window
+  m_untouched = 0;
+  if (!m_touched)
+  {
+    m_rawX[0] = m_rawX[1] = m_rawX[2] = raw.x;
+    m_rawY[0] = m_rawY[1] = m_rawY[2] = raw.y;
+  }
+  m_rawX[m_rawAt] = raw.x;
+  m_rawY[m_rawAt] = raw.y;
+  m_rawAt = (m_rawAt < 2) ? m_rawAt + 1 : 0;
+  if (m_touched < TOUCH_PRESS_COUNT)
+  {
+    m_touched++;
+  }
+
+  const int16_t x = touchMedian(m_rawX);
+  const int16_t y = touchMedian(m_rawY);
+
+  if (!m_pressed)
+  {
+    if (m_touched < TOUCH_PRESS_COUNT)
+    {
+      return;
+    }
+    m_filterX = x;
+    m_filterY = y;
+  }
+  else
+  {
+    m_filterX = (m_filterX + x + 1) >> 1;
+    m_filterY = (m_filterY + y + 1) >> 1;
+  }
+
+  // calibrated only when there is something to report
+  int16_t eventX, eventY;
+  calibrated(m_filterX, m_filterY, eventX, eventY);
+  if (!m_pressed)
+  {
+    m_pressed = true;
+    m_eventX = eventX;
+    m_eventY = eventY;
+    pushEvent(TouchPress, now);
+  }
+  else if ((abs(eventX - m_eventX) >= TOUCH_MOVE_PX) || (abs(eventY - m_eventY) >= TOUCH_MOVE_PX))
+  {
+    m_eventX = eventX;
+    m_eventY = eventY;
+    pushEvent(TouchMove, now);
+  }
+}
+
+#ifdef TOUCH_SCREEN_ACTIVE
+ISR(TIMER0_COMPA_vect)
+{
+  // every 1.024ms; a sample takes up to ~130us, millis() and the serial port go on meanwhile
+  static BYTE ticks = 0;
+  static bool sampling = false;
+  if (!touchSampled || sampling || (++ticks < TOUCH_SAMPLE_MS))
+  {
+    return;
+  }
+
+  ticks = 0;
+  sampling = true;
+  sei();
+  touchSampled->sample();
+  cli();
+  sampling = false;
+}
+#endif
+
+#endif // TOUCH_SCREEN_CALIBRATION
@@ -5,8 +5,31 @@
 #pragma once
 #include "config.h"
 
+// sampled at a fixed rate: from the timer 0 compare slot with an XPT2046 (millis() keeps the overflow),
+// from poll() with a passive one, whose pins are shared with the TFT and must not be touched mid-transfer
+#define TOUCH_SAMPLE_MS     10  // between samples
+#define TOUCH_PRESS_COUNT   2   // touched samples in a row for a press
+#define TOUCH_RELEASE_COUNT 3   // untouched samples in a row for a release
+#define TOUCH_MOVE_PX       2   // filtered position change reported as a move
+#define TOUCH_EVENTS        8   // queued, power of 2
+
+// calibration: screen = matrix * raw, 16.16 fixed point, stored after the automount journal
+#define TOUCH_CAL_EEPROM    2048
+#define TOUCH_CAL_MAGIC     0xCA
+#define TOUCH_CAL_ERROR     12  // px, worst crosshair off its fit for the calibration to be refused
+
+struct TouchEvent
+{
+  BYTE type;
+  int16_t x;                    // calibrated, px
+  int16_t y;
+  DWORD time;                   // millis() of the sample that caused it
+};
+
 #ifdef TOUCH_SCREEN_ACTIVE
-class Touch : private XPT2046_Bitbang
+class Touch : private XPT2046_Bitbang<TOUCH_DIN, TOUCH_DOUT, TOUCH_CLK, TOUCH_CS>
+#elif defined(TOUCH_SCREEN_PASSIVE_FAST)
+class Touch : private TouchScreen_Fast<TOUCH_XPLUS, TOUCH_YPLUS, TOUCH_XMINUS, TOUCH_YMINUS>
 #else
 class Touch : private TouchScreen
 #endif
@@ -14,21 +37,31 @@ class Touch : private TouchScreen
 
 public:
 
-#ifdef TOUCH_SCREEN_ACTIVE
-  Touch() : XPT2046_Bitbang(TOUCH_DIN, TOUCH_DOUT, TOUCH_CLK, TOUCH_CS) {};
+  enum EventType
+  {
+    TouchNone = 0,
+    TouchPress,
+    TouchMove,
+    TouchRelease
+  };
+
+#if defined(TOUCH_SCREEN_ACTIVE) || defined(TOUCH_SCREEN_PASSIVE_FAST)
+  Touch() {}; // pins are template arguments, resolved to port bits at compile time
 #else
   Touch() : TouchScreen(TOUCH_XPLUS, TOUCH_YPLUS, TOUCH_XMINUS, TOUCH_YMINUS, TOUCH_RX) {};
 #endif
 
   virtual ~Touch() {};
-   
+
   TSPoint getPointRaw()
   {
 #ifdef TOUCH_SCREEN_ACTIVE
     TSPoint result = XPT2046_Bitbang::getPoint();
+#elif defined(TOUCH_SCREEN_PASSIVE_FAST)
+    TSPoint result = TouchScreen_Fast::getPoint(); // leaves the shared pins as it found them
 #else
     TSPoint result = TouchScreen::getPoint();
-  
+
     // these two are usually shared with the TFT pins; restore their mode
     pinMode(TOUCH_YPLUS, OUTPUT);
     pinMode(TOUCH_XMINUS, OUTPUT);
@@ -36,14 +69,65 @@ public:
 
     return result;
   }
-  
+
   TSPoint getPoint() // calibrated
   {
-    TSPoint result = getPointRaw();    
-   
-    const int16_t x = map(result.y, TOUCH_CAL_X1, TOUCH_CAL_X2, 0, DISP_WIDTH);
-    const int16_t y = map(result.x, TOUCH_CAL_Y1, TOUCH_CAL_Y2, 0, DISP_HEIGHT);    
+    TSPoint result = getPointRaw();
+    if (result.z <= 0)
+    {
+      return result; // not touched or no sample, nothing to map
+    }
+
+    int16_t x, y;
+    calibrated(result.x, result.y, x, y);
     return TSPoint(x, y, result.z);
   }
-  
+
+  void calibrated(int16_t rawX, int16_t rawY, int16_t& x, int16_t& y) const
+  {
+    // multiplies and shifts only; rotation, swapped axes and a flipped display are in the matrix
+    x = (m_cal[0] * rawX + m_cal[1] * rawY + m_cal[2] + 0x8000) >> 16;
+    y = (m_cal[3] * rawX + m_cal[4] * rawY + m_cal[5] + 0x8000) >> 16;
+  }
+
+  // matrix of setRotation(1): from EEPROM, or from TOUCH_CAL_* if there is none valid there
+  void loadCalibration();
+  void storeCalibration(const int32_t* matrix);
+  static void flipCalibration(int32_t* matrix); // to or from setRotation(3)
+
+  // sampling engine, filtered presses, moves and releases queued as they happen
+  void begin();
+  void poll();                  // passive: samples when due, active: nothing to do
+  bool getEvent(TouchEvent& event);
+  void flushEvents();
+  void sample();                // one sample through the filter
+
+private:
+
+  void pushEvent(BYTE type, DWORD time);
+
+  int32_t m_cal[6];             // x = [0]*raw.x + [1]*raw.y + [2], y = [3]*raw.x + [4]*raw.y + [5]
+
+  // median of the last three raw samples, then IIR halfway towards it
+  int16_t m_rawX[3];
+  int16_t m_rawY[3];
+  BYTE m_rawAt;
+  int16_t m_filterX;
+  int16_t m_filterY;
+
+  BYTE m_touched;               // samples in a row
+  BYTE m_untouched;
+  bool m_pressed;
+  DWORD m_untouchedTime;        // first untouched sample, when the release happened
+  int16_t m_eventX;             // calibrated position reported last
+  int16_t m_eventY;
+  DWORD m_sampleTime;           // passive: last sample taken
+
+  TouchEvent m_events[TOUCH_EVENTS];
+  volatile BYTE m_eventHead;
+  volatile BYTE m_eventTail;
 };
+
+// crosshair calibration: TOUCH_SCREEN_CALIBRATION builds, or the screen held while powering up
+bool touchCalibrationWanted(Touch& touch);
+bool touchCalibrate(MCUFRIEND_kbv& display, Touch& touch);
@@ -6,6 +6,10 @@
 
 #ifndef TOUCH_SCREEN_CALIBRATION
 
+#ifdef UI_DASHBOARD
+#include "src/MCUFRIEND_kbv/FreeSevenSegNumFontPlusPlus.h"
+#endif
+
 // colors
 #define COLOR_BLACK      0
 #define COLOR_WHITE      0xFFFF
@@ -14,14 +18,71 @@
 #define COLOR_OUTSIDE    0x410
 #define COLOR_BACKGROUND 0xC618
 #define COLOR_SHADOW     0x8410
+#define COLOR_GREEN      0x07E0
+#define COLOR_DARKGREEN  0x0320
+#define COLOR_RED        0xF800
+
+// layout, px
+#define CLIENT_X         (DISP_WIDTH/32)
+#define CLIENT_Y         (DISP_HEIGHT/24)
+#define CLIENT_WIDTH     ((DISP_WIDTH*187)/200)
+#define CLIENT_HEIGHT    ((DISP_HEIGHT*91)/100)
+#define BOX_X            (DISP_WIDTH/16)
+#define BOX_Y            ((DISP_HEIGHT/4)-22)
+#define BOX_WIDTH        ((DISP_WIDTH*87)/100)
+#define BOX_HEIGHT       (((DISP_HEIGHT*3)/5)+24)
+#define BOX_TEXT_Y       (((DISP_HEIGHT*20)/47)+12) // with buttons below
+#define PICKER_X         (DISP_WIDTH/18)
+#define PICKER_Y         ((DISP_HEIGHT*4)/25)
+#define PICKER_WIDTH     ((DISP_WIDTH*89)/100)
+#define PICKER_HEIGHT    ((DISP_HEIGHT*14)/25)
+#define PICKER_ROWS      6
+#define PICKER_ROW       (PICKER_HEIGHT/PICKER_ROWS)
+#define PICKER_DETAILS_Y ((DISP_HEIGHT*39)/50)
+
+// chrome, drawn in one pass each
+#define CHROME_FILL      1 // span in the color asked for
+
+static const Ui::ChromeBand chromeTitleBar[] PROGMEM =
+{
+  {22,               {CLIENT_WIDTH, 0, 0},      {CHROME_FILL, 0, 0}}
+};
+
+static const Ui::ChromeBand chromeMessageBox[] PROGMEM =
+{
+  {2,                {BOX_WIDTH, 0, 0},         {COLOR_BLACK, 0, 0}},
+  {20,               {2, BOX_WIDTH-4, 2},       {COLOR_BLACK, COLOR_BLUE, COLOR_BLACK}},
+  {BOX_HEIGHT-24,    {2, BOX_WIDTH-4, 2},       {COLOR_BLACK, COLOR_BACKGROUND, COLOR_BLACK}},
+  {2,                {BOX_WIDTH, 0, 0},         {COLOR_BLACK, 0, 0}}
+};
+
+static const Ui::ChromeBand chromeFilePicker[] PROGMEM =
+{
+  {1,                {PICKER_WIDTH, 0, 0},      {COLOR_BLACK, 0, 0}},
+  {PICKER_HEIGHT-2,  {1, PICKER_WIDTH-2, 1},    {COLOR_BLACK, COLOR_WHITE, COLOR_BLACK}},
+  {1,                {PICKER_WIDTH, 0, 0},      {COLOR_BLACK, 0, 0}}
+};
 
 Ui::Ui()
 {
-  m_buttonRow = NULL;
+  m_buttonBar = NULL;
+  m_buttonsShown = 0;
   m_buttonsCount = 0;
   m_filePicking = false;
   m_filePickerCount = 0;
   m_filePickerSel = 0;
+  m_filePickerEntries = NULL;
+  m_filePickerShownSel = 0;
+  m_dragging = false;
+  m_scrollStep = 0;
+  m_touchDown = false;
+  m_touchX = 0;
+  m_touchY = 0;
+  m_textColor = COLOR_BLACK;
+  m_textBackground = COLOR_BACKGROUND;
+  memset(m_scene, 0, sizeof(m_scene));
+  m_sceneOpen = false;
+  m_sceneLost = false;
   
   m_tft.reset();
   
@@ -41,313 +102,888 @@ Ui::Ui()
   m_tft.fillScreen(COLOR_OUTSIDE);
   m_tft.setFont(&Progmem::m_vgaFont); // 8x16, monospace
   m_tft.setCursor(0, 0);
+
+  // screen held while powering up: crosshair calibration, kept in EEPROM
+  if (touchCalibrationWanted(m_touch))
+  {
+    touchCalibrate(m_tft, m_touch);
+    m_tft.fillScreen(COLOR_OUTSIDE);
+  }
       
   // make title  
   clearScreen();
+  
+  m_touch.begin();
 }
 
 void Ui::clearScreen()
 {
-  m_tft.fillRect(DISP_WIDTH/32, DISP_HEIGHT/24, DISP_WIDTH*0.935, DISP_HEIGHT*0.91, COLOR_BACKGROUND);
-  m_tft.fillRect(DISP_WIDTH/32, DISP_HEIGHT/24, DISP_WIDTH*0.935, 22, COLOR_BLUE);
-  setCursorY((DISP_HEIGHT/24)+15);
-  m_tft.setTextColor(COLOR_WHITE);
-  outText(Progmem::getString(Progmem::uiTitle), true);  
-  m_tft.setTextColor(COLOR_BLACK);
-  
-  if (m_buttonRow)
+  // starts a new scene: what is described again and unchanged is left as it is on the screen
+  sceneBegin();
+  if (sceneItem(CLIENT_X, CLIENT_Y, CLIENT_WIDTH, CLIENT_HEIGHT, 0, COLOR_OUTSIDE))
   {
-    delete[] m_buttonRow;
+    m_tft.fillRect(CLIENT_X, CLIENT_Y, CLIENT_WIDTH, CLIENT_HEIGHT, COLOR_BACKGROUND);
   }
+  drawTitleBar(COLOR_BLUE);
   
-  m_buttonRow = NULL;
   m_buttonsCount = 0;
   m_filePickerCount = 0;
   m_filePickerSel = 0;
 }
 
-void Ui::outText(const char* text, bool centerHorz, bool centerVert, bool clearLine)
+UiText::UiText(const char* text, WORD length)
+{
+  m_text = text;
+  m_length = length;
+  m_progmem = false;
+  m_format = false;
+  rewind();
+}
+
+UiText::UiText(BYTE progmemString)
 {
-  if (!text)
+  m_text = Progmem::getString(progmemString);
+  m_length = Progmem::getLength(progmemString);
+  m_progmem = true;
+  m_format = false;
+  rewind();
+}
+
+UiText::UiText(BYTE progmemFormat, UiArg arg0, UiArg arg1, UiArg arg2, UiArg arg3)
+{
+  m_text = Progmem::getString(progmemFormat);
+  m_progmem = true;
+  m_format = true;
+  m_args[0] = arg0;
+  m_args[1] = arg1;
+  m_args[2] = arg2;
+  m_args[3] = arg3;
+  
+  // expanded once to be measured
+  m_length = 0;
+  rewind();
+  while (next())
   {
-    return;
+    m_length++;
+  }
+  rewind();
+}
+
+void UiText::rewind()
+{
+  m_at = 0;
+  m_arg = 0;
+  m_expanding = NULL;
+}
+
+char UiText::next()
+{
+  if (!m_format)
+  {
+    if (m_at >= m_length)
+    {
+      return 0;
+    }
+    return m_progmem ? pgm_read_byte(&m_text[m_at++]) : m_text[m_at++];
   }
   
+  for (;;)
+  {
+    // argument being expanded
+    if (m_expanding)
+    {
+      const char c = *m_expanding++;
+      if (c)
+      {
+        return c;
+      }
+      m_expanding = NULL;
+    }
+    
+    char c = pgm_read_byte(&m_text[m_at]);
+    if (!c)
+    {
+      return 0;
+    }
+    m_at++;
+    if (c != '%')
+    {
+      return c;
+    }
+    
+    // %u, %lu, %s, %c; anything else is printed as it is (%%)
+    c = pgm_read_byte(&m_text[m_at++]);
+    if (c == 'l')
+    {
+      c = pgm_read_byte(&m_text[m_at++]);
+    }
+    
+    const UiArg arg = (m_arg < UI_TEXT_ARGS) ? m_args[m_arg] : UiArg();
+    switch (c)
+    {
+    case 'u':
+      ultoa(arg.number, m_number, 10);
+      m_expanding = m_number;
+      break;
+    case 's':
+      m_expanding = arg.text ? arg.text : "";
+      break;
+    case 'c':
+      m_number[0] = (char)arg.number;
+      m_number[1] = 0;
+      m_expanding = m_number;
+      break;
+    default:
+      return c;
+    }
+    m_arg++;
+  }
+}
+
+void Ui::outText(UiText text, bool centerHorz, bool centerVert, bool clearLine)
+{
+  const WORD length = text.length();
   if (centerHorz)
   {
-    setCursorX((DISP_WIDTH/2) - (strlen(text) * 4));
+    setCursorX((DISP_WIDTH/2) - (length * 4));
   }
   if (centerVert)
   {
     setCursorY((DISP_HEIGHT/2) + 8);
   }
+  m_filePicking = false;
+  
+  // text cells, or the whole line if cleared
+  WORD hash = sceneHash(text, m_textColor);
+  hash = sceneHash(clearLine ? "|" : "", m_textBackground, hash);
+  const WORD X = clearLine ? CLIENT_X : getCursorX();
+  const WORD width = clearLine ? CLIENT_WIDTH : length * 8;
+  if (!sceneItem(X, getCursorY()-12, width, 16, hash, m_textBackground))
+  {
+    setCursorX(getCursorX() + (length * 8));
+    return;
+  }
+  
   if (clearLine)
   {
-    m_tft.fillRect(DISP_WIDTH/32, m_tft.getCursorY()-12, DISP_WIDTH*0.935, 16, COLOR_BACKGROUND);
+    m_tft.fillRect(CLIENT_X, m_tft.getCursorY()-12, CLIENT_WIDTH, 16, COLOR_BACKGROUND);
   }
   
-  m_tft.print(text);
-  m_filePicking = false;
+  printText(text);
 }
 
-void Ui::outButtons(const Button* buttons, const BYTE count, WORD widthEach, WORD heightEach)
+void Ui::drawTitleBar(WORD color)
 {
-  if (!buttons || !count)
+  // blue, or gray while a message box is shown
+  if (sceneItem(CLIENT_X, CLIENT_Y, CLIENT_WIDTH, 22, color, COLOR_BACKGROUND))
   {
-    return;
+    drawChrome(CLIENT_X, CLIENT_Y, chromeTitleBar, 1, color);
   }
   
-  if (m_buttonRow)
+  setCursorY(CLIENT_Y+15);
+  setTextColor(COLOR_WHITE, color);
+  outText(Progmem::uiTitle, true);  
+  setTextColor(COLOR_BLACK, COLOR_BACKGROUND);
+}
+
+void Ui::drawMessageBox()
+{
+  if (sceneItem(BOX_X, BOX_Y, BOX_WIDTH, BOX_HEIGHT, 'B', COLOR_BACKGROUND))
   {
-    delete[] m_buttonRow;
-  }   
-  m_buttonRow = new ButtonRow[count];  
-  if (!m_buttonRow)
+    drawChrome(BOX_X, BOX_Y, chromeMessageBox, sizeof(chromeMessageBox) / sizeof(Ui::ChromeBand));
+  }
+  setTextColor(COLOR_WHITE, COLOR_BLUE);
+}
+
+void Ui::drawChrome(WORD X, WORD Y, const ChromeBand* bands, BYTE count, WORD fill)
+{
+  // one address window, each pixel written once instead of overlapping fills
+  WORD width = 0;
+  WORD height = 0;
+  for (BYTE band = 0; band < count; band++)
   {
-    return;
+    height += pgm_read_byte(&bands[band].rows);
+  }
+  for (BYTE span = 0; span < 3; span++)
+  {
+    width += pgm_read_word(&bands[0].length[span]);
   }
-  m_buttonsCount = count;
-  
-  const BYTE spacing = DISP_WIDTH/80;
-  const WORD widthAll = (widthEach * count) + (spacing * (count-1));
   
-  WORD X = (DISP_WIDTH/2) - (widthAll/2) - 1;
-  const WORD Y = getCursorY();
-    
-  for (BYTE at = 0; at < count; at++)
-  {    
-    m_buttonRow[at].action = buttons[at].action;    
-    m_buttonRow[at].X1 = X;
-    m_buttonRow[at].Y1 = Y;
-    
-    X += widthEach;
-    m_buttonRow[at].X2 = X;
-    m_buttonRow[at].Y2 = Y + heightEach;
-    X += spacing;
+  m_tft.setAddrWindow(X, Y, X + width - 1, Y + height - 1);
+  bool first = true;
+  for (BYTE band = 0; band < count; band++)
+  {
+    ChromeBand rows;
+    memcpy_P(&rows, &bands[band], sizeof(ChromeBand));
+    for (BYTE span = 0; span < 3; span++)
+    {
+      rows.color[span] = (rows.color[span] == CHROME_FILL) ? fill : rows.color[span];
+    }
     
-    m_tft.drawFastHLine(m_buttonRow[at].X1, m_buttonRow[at].Y1, m_buttonRow[at].X2 - m_buttonRow[at].X1 - 1, COLOR_WHITE);
-    m_tft.drawFastVLine(m_buttonRow[at].X1, m_buttonRow[at].Y1, m_buttonRow[at].Y2 - m_buttonRow[at].Y1 - 1, COLOR_WHITE);
-    m_tft.drawFastHLine(m_buttonRow[at].X1, m_buttonRow[at].Y2, m_buttonRow[at].X2 - m_buttonRow[at].X1, COLOR_BLACK);
-    m_tft.drawFastVLine(m_buttonRow[at].X2, m_buttonRow[at].Y1, m_buttonRow[at].Y2 - m_buttonRow[at].Y1, COLOR_BLACK);
-    m_tft.drawFastHLine(m_buttonRow[at].X1 + 1, m_buttonRow[at].Y2 - 1, m_buttonRow[at].X2 - m_buttonRow[at].X1 - 1, COLOR_SHADOW);
-    m_tft.drawFastVLine(m_buttonRow[at].X2 - 1, m_buttonRow[at].Y1 + 1, m_buttonRow[at].Y2 - m_buttonRow[at].Y1 - 1, COLOR_SHADOW);
+    // a band of one color is a single run
+    if (!rows.length[1] && !rows.length[2])
+    {
+      m_tft.pushRun(rows.color[0], rows.length[0] * rows.rows, first);
+      first = false;
+      continue;
+    }
     
-    const char* text = Progmem::getString(buttons[at].progmemCaption);
-    setCursor(m_buttonRow[at].X1 + ((m_buttonRow[at].X2 - m_buttonRow[at].X1)/2) - (strlen(text) * 4),
-              m_buttonRow[at].Y1 + ((m_buttonRow[at].Y2 - m_buttonRow[at].Y1)/2) + 4);
-    m_tft.print(text);
+    while (rows.rows--)
+    {
+      for (BYTE span = 0; span < 3; span++)
+      {
+        m_tft.pushRun(rows.color[span], rows.length[span], first);
+        first = false;
+      }
+    }
   }
+  
+  // full screen window again, as fillRect() leaves it for controllers that need it
+  m_tft.setAddrWindow(0, 0, m_tft.width() - 1, m_tft.height() - 1);
 }
 
-void Ui::messageBox(const char* content, const char* caption, bool hasButtons)
+void Ui::drawButton(WORD X, WORD Y, BYTE width, BYTE height, WORD face)
 {
-  if (!content)
-  {
-    return;
-  }
+  // (width+1) x (height+1) px: white top left, shadow and black bottom right edges, face, in one address window
+  m_tft.setAddrWindow(X, Y, X + width, Y + height);
   
-  m_tft.setTextColor(COLOR_WHITE);  
-  m_tft.fillRect(DISP_WIDTH/16, (DISP_HEIGHT/4)-22, DISP_WIDTH*0.87, (DISP_HEIGHT*0.6)+24, COLOR_BLACK);
-  m_tft.fillRect((DISP_WIDTH/16)+2, (DISP_HEIGHT/4)-20, (DISP_WIDTH*0.87)-4, (DISP_HEIGHT*0.6)+20, COLOR_BACKGROUND);
-  m_tft.fillRect((DISP_WIDTH/16)+2, (DISP_HEIGHT/4)-20, (DISP_WIDTH*0.87)-4, 20, COLOR_BLUE);
-  if (caption)
+  m_tft.pushRun(COLOR_WHITE, width - 1, true);
+  m_tft.pushRun(face, 1, false);
+  m_tft.pushRun(COLOR_BLACK, 1, false);
+  for (BYTE row = 1; row < height - 1; row++)
   {
-    setCursorY((DISP_HEIGHT/4)-7);
-    outText(caption, true);  
-  }  
+    m_tft.pushRun(COLOR_WHITE, 1, false);
+    m_tft.pushRun(face, width - 2, false);
+    m_tft.pushRun(COLOR_SHADOW, 1, false);
+    m_tft.pushRun(COLOR_BLACK, 1, false);
+  }
+  m_tft.pushRun(face, 1, false);
+  m_tft.pushRun(COLOR_SHADOW, width - 1, false);
+  m_tft.pushRun(COLOR_BLACK, 1, false);
+  m_tft.pushRun(COLOR_BLACK, width, false);
+  m_tft.pushRun(face, 1, false);
   
-  m_tft.setTextColor(COLOR_BLACK);  
-  setCursorY(hasButtons ? (DISP_HEIGHT/2.35)+12 : (DISP_HEIGHT/2)+12);
-  outText(content, true);  
+  m_tft.setAddrWindow(0, 0, m_tft.width() - 1, m_tft.height() - 1);
+}
+
+void Ui::setTextColor(WORD color, WORD background)
+{
+  // background: the surface the text goes on, its character cells are filled with it
+  m_textColor = color;
+  m_textBackground = background;
+  m_tft.setTextColor(color);
+}
+
+void Ui::printText(UiText& text)
+{
+  // 8x16 character cells blitted from the font bitmap, one address window each,
+  // instead of a window and a write per set pixel through Adafruit_GFX
+  const WORD baseline = getCursorY();
+  WORD X = getCursorX();
   
-  // make "parent" bar gray
-  m_tft.setTextColor(COLOR_WHITE);
-  m_tft.fillRect(DISP_WIDTH/32, DISP_HEIGHT/24, DISP_WIDTH*0.935, 22, COLOR_SHADOW);
-  setCursorY((DISP_HEIGHT/24)+15);  
-  outText(Progmem::getString(Progmem::uiTitle), true);
-  m_tft.setTextColor(COLOR_BLACK);
+  const GFXfont* font = &Progmem::m_vgaFont;
+  const BYTE* bitmap = (const BYTE*)pgm_read_ptr(&font->bitmap);
+  const GFXglyph* glyphs = (const GFXglyph*)pgm_read_ptr(&font->glyph);
+  const BYTE first = pgm_read_word(&font->first);
+  const BYTE last = pgm_read_word(&font->last);
   
-  if (hasButtons)
+  BYTE cell[16]; // one byte per pixel row, MSB left
+  text.rewind();
+  for (BYTE code; (code = text.next()) && (X + 8 <= DISP_WIDTH); X += 8)
   {
-    setCursorY(DISP_HEIGHT*0.65);
+    const BYTE c = (code < first) || (code > last) ? ' ' : code;
+    const GFXglyph* glyph = &glyphs[c - first];
+    
+    WORD offset = pgm_read_word(&glyph->bitmapOffset);
+    const BYTE width = pgm_read_byte(&glyph->width);
+    const BYTE height = pgm_read_byte(&glyph->height);
+    const signed char left = pgm_read_byte(&glyph->xOffset);
+    const signed char top = (signed char)pgm_read_byte(&glyph->yOffset) + 12; // cell rows start 12 above the baseline
+    
+    BYTE bits = 0;
+    BYTE bit = 0;
+    for (BYTE row = 0; row < 16; row++)
+    {
+      const bool glyphRow = (row >= top) && (row < top + height);
+      BYTE pixels = 0;
+      for (BYTE column = 0; column < 8; column++)
+      {
+        if (glyphRow && (column >= left) && (column < left + width))
+        {
+          if (!(bit++ & 7))
+          {
+            bits = pgm_read_byte(&bitmap[offset++]);
+          }
+          if (bits & 0x80)
+          {
+            pixels |= 0x80 >> column;
+          }
+          bits <<= 1;
+        }
+      }
+      cell[row] = pixels;
+    }
+    
+    // the driver expands the bits, strobing only where a color repeats
+    m_tft.setAddrWindow(X, baseline - 12, X + 7, baseline + 3);
+    m_tft.pushBits(cell, 8 * 16, m_textColor, m_textBackground, true);
   }
+  
+  // full screen window again, as fillRect() leaves it for controllers that need it
+  m_tft.setAddrWindow(0, 0, m_tft.width() - 1, m_tft.height() - 1);
+  setCursor(X, baseline);
 }
 
-void Ui::messageBox(BYTE progmemContent, BYTE progmemCaption, bool hasButtons)
-{  
-  m_tft.setTextColor(COLOR_WHITE);
-  m_tft.fillRect(DISP_WIDTH/16, (DISP_HEIGHT/4)-22, DISP_WIDTH*0.87, (DISP_HEIGHT*0.6)+24, COLOR_BLACK);
-  m_tft.fillRect((DISP_WIDTH/16)+2, (DISP_HEIGHT/4)-20, (DISP_WIDTH*0.87)-4, (DISP_HEIGHT*0.6)+20, COLOR_BACKGROUND);
-  m_tft.fillRect((DISP_WIDTH/16)+2, (DISP_HEIGHT/4)-20, (DISP_WIDTH*0.87)-4, 20, COLOR_BLUE);
-  setCursorY((DISP_HEIGHT/4)-7);
-  outText(Progmem::getString(progmemCaption), true); //0 defaults to Progmem::Empty
+#ifdef UI_DASHBOARD
+void Ui::outIndicator(BYTE indicator)
+{
+  // 12x12, repainted only when its color changes
+  static const WORD colors[] PROGMEM = {COLOR_BACKGROUND, COLOR_DARKGREEN, COLOR_GREEN, COLOR_RED};
+  const WORD color = pgm_read_word(&colors[indicator & 3]);
+  const WORD X = getCursorX();
+  const WORD Y = getCursorY() - 11;
   
-  m_tft.setTextColor(COLOR_BLACK);  
-  setCursorY(hasButtons ? (DISP_HEIGHT/2.35)+12 : (DISP_HEIGHT/2)+12);
-  outText(Progmem::getString(progmemContent), true);  
+  if (sceneItem(X, Y, 12, 12, color, m_textBackground))
+  {
+    m_tft.fillRect(X + 1, Y + 1, 10, 10, color);
+    m_tft.drawRect(X, Y, 12, 12, COLOR_SHADOW);
+  }
+  setCursorX(X + 12);
+}
+
+void Ui::outSevenSeg(const char* text)
+{
+  // UI_SEG_WIDTH x UI_SEG_HEIGHT cells, blitted like printText() does; a cell is drawn only if its character changed,
+  // so a value ticking over costs one or two cells. Characters the font lacks are blank
+  const WORD baseline = getCursorY();
+  WORD X = getCursorX();
   
-  m_tft.setTextColor(COLOR_WHITE);
-  m_tft.fillRect(DISP_WIDTH/32, DISP_HEIGHT/24, DISP_WIDTH*0.935, 22, COLOR_SHADOW);
-  setCursorY((DISP_HEIGHT/24)+15);
-  outText(Progmem::getString(Progmem::uiTitle), true);
-  m_tft.setTextColor(COLOR_BLACK);
+  const GFXfont* font = &FreeSevenSegNumFontPlusPlus;
+  const BYTE* bitmap = (const BYTE*)pgm_read_ptr(&font->bitmap);
+  const GFXglyph* glyphs = (const GFXglyph*)pgm_read_ptr(&font->glyph);
+  const BYTE first = pgm_read_word(&font->first);
+  const BYTE last = pgm_read_word(&font->last);
   
-  if (hasButtons)
+  for (; text && *text && (X + UI_SEG_WIDTH <= DISP_WIDTH); text++, X += UI_SEG_WIDTH)
   {
-    setCursorY(DISP_HEIGHT*0.65);
+    if (!sceneItem(X, baseline - UI_SEG_HEIGHT, UI_SEG_WIDTH, UI_SEG_HEIGHT, sceneHash(UiText(text, 1), m_textColor), m_textBackground))
+    {
+      continue;
+    }
+    
+    const BYTE c = *text;
+    const bool drawn = (c >= first) && (c <= last);
+    const GFXglyph* glyph = &glyphs[drawn ? c - first : 0];
+    WORD offset = pgm_read_word(&glyph->bitmapOffset);
+    const BYTE width = drawn ? pgm_read_byte(&glyph->width) : 0;
+    const BYTE height = drawn ? pgm_read_byte(&glyph->height) : 0;
+    const signed char left = pgm_read_byte(&glyph->xOffset);
+    const signed char top = (signed char)pgm_read_byte(&glyph->yOffset) + UI_SEG_HEIGHT;
+    
+    m_tft.setAddrWindow(X, baseline - UI_SEG_HEIGHT, X + UI_SEG_WIDTH - 1, baseline - 1);
+    BYTE bits = 0;
+    BYTE bit = 0;
+    for (BYTE row = 0; row < UI_SEG_HEIGHT; row++)
+    {
+      BYTE pixels[UI_SEG_WIDTH / 8] = {0};
+      if ((row >= top) && (row < top + height))
+      {
+        for (BYTE column = left; column < left + width; column++)
+        {
+          if (!(bit++ & 7))
+          {
+            bits = pgm_read_byte(&bitmap[offset++]);
+          }
+          if (bits & 0x80)
+          {
+            pixels[column >> 3] |= 0x80 >> (column & 7);
+          }
+          bits <<= 1;
+        }
+      }
+      m_tft.pushBits(pixels, UI_SEG_WIDTH, m_textColor, m_textBackground, !row);
+    }
   }
+  
+  m_tft.setAddrWindow(0, 0, m_tft.width() - 1, m_tft.height() - 1);
+  setCursor(X, baseline);
 }
+#endif // UI_DASHBOARD
 
-void Ui::drawFilePicker(bool rootDirectory, char* entriesPipeDelimited, BYTE curSel, DWORD curPage, DWORD pages)
+void Ui::outButtons(const ButtonBar* bar, BYTE shown)
 {
-  // shows file filter (*.P32), six file entries per page, indicator and button bar
-  const BYTE pickerMaxEntries = 6;
-  const WORD pickerHeight = DISP_HEIGHT*0.56;
+  // laid out at compile time, the hit boxes are looked up in the same table
+  const BYTE count = bar ? pgm_read_byte(&bar->count) : 0;
+  if (!count || (count > UI_MAX_BUTTONS))
+  {
+    return;
+  }
   
-  if (!entriesPipeDelimited)
+  m_buttonBar = bar;
+  m_buttonsShown = shown & ((1 << count) - 1);
+  m_buttonsCount = 0;
+  for (BYTE at = 0; at < count; at++)
+  {
+    m_buttonsCount += (m_buttonsShown >> at) & 1;
+  }
+  if (!m_buttonsCount)
   {
     return;
   }
-  const WORD oldLen = strlen(entriesPipeDelimited);
   
-  const bool redrawWhole = !m_filePicking;
-  if (redrawWhole)
+  const BYTE width = pgm_read_byte(&bar->width);
+  const BYTE height = pgm_read_byte(&bar->height);
+  const WORD Y = pgm_read_word(&bar->Y);
+  WORD X = pgm_read_word(&bar->left[m_buttonsCount-1]);
+    
+  for (BYTE at = 0; at < count; at++)
   {
-    clearScreen();       
-    m_tft.fillRect(DISP_WIDTH/18, DISP_HEIGHT/6.25, DISP_WIDTH*0.89, pickerHeight, COLOR_BLACK);
+    if (!(m_buttonsShown & (1 << at)))
+    {
+      continue;
+    }
+    
+    // unchanged buttons not painted again
+    const WORD X1 = X;
+    X += width + UI_BUTTON_SPACING;
+    
+    UiText text(pgm_read_byte(&bar->buttons[at].progmemCaption));
+    if (!sceneItem(X1, Y, width + 1, height + 1, sceneHash(text, m_textColor), m_textBackground))
+    {
+      continue;
+    }
     
-    const Ui::Button buttonRow[] = { {Ui::ButtonAction::PgUp, Progmem::btnPgUp}, 
-                                     {Ui::ButtonAction::PgDn, Progmem::btnPgDn},
-                                     {Ui::ButtonAction::Up, Progmem::btnUp},
-                                     {Ui::ButtonAction::Down, Progmem::btnDown},
-                                     {Ui::ButtonAction::Open, Progmem::btnOpen},
-                                     {Ui::ButtonAction::Back, Progmem::btnBack} };
+    drawButton(X1, Y, width, height, m_textBackground);
+    setCursor(X1 + (width/2) - (text.length() * 4), Y + (height/2) + 4);
+    printText(text);
+  }
+}
 
-    setCursorY(DISP_HEIGHT*0.82);
-    outButtons(buttonRow, BUTTONS_COUNTOF(buttonRow), DISP_WIDTH/8, DISP_HEIGHT/10);
+// retained scene: rectangles on the screen, with a hash of what they show
+// nothing is read back from the display (16-bit shields are write only)
+
+WORD Ui::sceneHash(UiText text, WORD color, WORD hash)
+{
+  hash = _crc16_update(hash, color & 0xFF);
+  hash = _crc16_update(hash, color >> 8);
+  text.rewind();
+  for (char c; (c = text.next()); )
+  {
+    hash = _crc16_update(hash, c);
+  }
+  return hash;
+}
+
+void Ui::sceneBegin()
+{
+  // whatever is not described again is erased by sceneEnd(), or once something new is drawn over it
+  sceneEnd();
+  for (BYTE index = 0; index < UI_SCENE_ITEMS; index++)
+  {
+    if (m_scene[index].state == SceneLive)
+    {
+      m_scene[index].state = m_sceneLost ? SceneFree : SceneStale;
+    }
   }
   
-  snprintf(m_stringBuffer, sizeof(m_stringBuffer)-1, Progmem::getString(Progmem::uiPickerDetails), curPage, pages);
-  setCursorY(DISP_HEIGHT*0.78);
-  outText(m_stringBuffer, true, false, !redrawWhole);
+  m_sceneLost = false;
+  m_sceneOpen = true;
+}
+
+void Ui::sceneEnd()
+{
+  // erases what was left over from the previous scene
+  if (!m_sceneOpen)
+  {
+    return;
+  }
   
-  m_tft.fillRect((DISP_WIDTH/18)+1, (DISP_HEIGHT/6.25)+1, (DISP_WIDTH*0.89)-2, pickerHeight-2, COLOR_WHITE);
-  const BYTE pickerItemHeight = pickerHeight / pickerMaxEntries;
+  for (BYTE index = 0; index < UI_SCENE_ITEMS; index++)
+  {
+    if (m_scene[index].state == SceneStale)
+    {
+      sceneErase(index, true);
+    }
+  }
   
-  char* entry = strtok(entriesPipeDelimited, "|");
-  if (!entry)
+  m_sceneOpen = false;
+}
+
+bool Ui::sceneContains(const SceneItem& outer, WORD X, WORD Y, WORD W, WORD H)
+{
+  return (outer.X <= X) && (outer.Y <= Y) && (outer.X + outer.W >= X + W) && (outer.Y + outer.H >= Y + H);
+}
+
+void Ui::sceneErase(BYTE index, bool fill)
+{
+  // frees an item and the leftovers within it, fill: erases it from the screen too
+  SceneItem& item = m_scene[index];
+  if (fill)
   {
-    entry = entriesPipeDelimited;
+    m_tft.fillRect(item.X, item.Y, item.W, item.H, item.under);
   }
   
-  for (WORD item = 1; item <= pickerMaxEntries; item++)
+  for (BYTE inner = 0; inner < UI_SCENE_ITEMS; inner++)
   {
-    const WORD itemY = (DISP_HEIGHT/6.25)+(item*pickerItemHeight);
-    setCursor((DISP_WIDTH/18)+7, itemY-7);
-    
-    if (item < pickerMaxEntries)
+    const SceneItem& leftover = m_scene[inner];
+    if ((inner != index) && (leftover.state == SceneStale) && sceneContains(item, leftover.X, leftover.Y, leftover.W, leftover.H))
     {
-      m_tft.drawFastHLine((DISP_WIDTH/18)+1, itemY, (DISP_WIDTH*0.89)-1, COLOR_SHADOW);  
+      m_scene[inner].state = SceneFree;
     }
-    
-    if (curSel == item)
+  }
+  item.state = SceneFree;
+}
+
+bool Ui::sceneItem(WORD X, WORD Y, WORD W, WORD H, WORD hash, WORD under)
+{
+  // true: to be drawn, as it is new or changed, false: on the screen already
+  // under: what is beneath, to erase it with
+  if (!W || !H)
+  {
+    return true;
+  }
+  
+  for (BYTE index = 0; index < UI_SCENE_ITEMS; index++)
+  {
+    SceneItem& item = m_scene[index];
+    if (!item.state || (item.X != X) || (item.Y != Y) || (item.W != W) || (item.H != H) || (item.hash != hash))
     {
-      m_tft.fillRect((DISP_WIDTH/18)+1, itemY-21, (DISP_WIDTH*0.89)-2, pickerItemHeight, COLOR_BROWN);
-      m_tft.setTextColor(COLOR_WHITE);
+      continue;
     }
     
-    if ((item == 1) && (curPage == 1))
+    // unless on a leftover that is about to be erased
+    bool onStale = false;
+    for (BYTE outer = 0; outer < UI_SCENE_ITEMS; outer++)
     {
-      outText(Progmem::getString(rootDirectory ? Progmem::uiPickerRootDir : Progmem::uiPickerOneLevelUp));
+      onStale = onStale || ((outer != index) && (m_scene[outer].state == SceneStale) && sceneContains(m_scene[outer], X, Y, W, H));
     }
-    else if (entry && strlen(entry))
+    if (!onStale)
     {
-      outText(entry);
-      entry = strtok(NULL, "|");
+      item.state = SceneLive;
+      return false;
     }
-    
-    if (curSel == item)
+  }
+  
+  // drawn over: gone; partly covered, the rest of it erased first
+  // what contains the new one in this scene is beneath it and stays, leftovers do not
+  for (BYTE index = 0; index < UI_SCENE_ITEMS; index++)
+  {
+    const SceneItem& item = m_scene[index];
+    if (!item.state || (item.X >= X + W) || (X >= item.X + item.W) || (item.Y >= Y + H) || (Y >= item.Y + item.H))
     {
-      m_tft.setTextColor(COLOR_BLACK);
+      continue;
     }
     
-    m_filePickerCount = item;
-    if (!entry || !strlen(entry))
+    const bool contained = (X <= item.X) && (Y <= item.Y) && (X + W >= item.X + item.W) && (Y + H >= item.Y + item.H);
+    if ((item.state == SceneLive) && !contained && sceneContains(item, X, Y, W, H))
     {
-      break;
+      continue;
     }
+    sceneErase(index, !contained);
+  }
+  
+  BYTE slot = 0;
+  while ((slot < UI_SCENE_ITEMS) && m_scene[slot].state)
+  {
+    slot++;
+  }
+  
+  // no room: untracked, the next scene is drawn whole
+  if (slot == UI_SCENE_ITEMS)
+  {
+    m_sceneLost = true;
+    return true;
+  }
+  
+  SceneItem& item = m_scene[slot];
+  item.X = X;
+  item.Y = Y;
+  item.W = W;
+  item.H = H;
+  item.hash = hash;
+  item.under = under;
+  item.state = SceneLive;
+  return true;
+}
+
+void Ui::messageBox(UiText content, UiText caption, bool hasButtons)
+{
+  drawMessageBox();
+  setCursorY(BOX_Y+15);
+  outText(caption, true);
+  
+  setTextColor(COLOR_BLACK, COLOR_BACKGROUND);  
+  setCursorY(hasButtons ? BOX_TEXT_Y : (DISP_HEIGHT/2)+12);
+  outText(content, true);  
+  
+  // make "parent" bar gray
+  drawTitleBar(COLOR_SHADOW);
+}
+
+void Ui::drawFilePicker(bool rootDirectory, char* entriesPipeDelimited, BYTE curSel, DWORD curPage, DWORD pages)
+{
+  // shows file filter (*.P32), six file entries per page, indicator and button bar
+  if (!entriesPipeDelimited)
+  {
+    return;
   }
   
-  // restore pipe delimiters modified by strtok
-  for (WORD index = 0; index < oldLen; index++)
+  const bool redrawWhole = !m_filePicking;
+  if (redrawWhole)
+  {
+    clearScreen();       
+    outButtons(&m_barFilePicker);
+  }
+  
+  drawFilePickerDetails(curPage, pages, !redrawWhole);
+  
+  // border and blank list at once, or the list only
+  if (sceneItem(PICKER_X, PICKER_Y, PICKER_WIDTH, PICKER_HEIGHT, 'P', COLOR_BACKGROUND))
+  {
+    drawChrome(PICKER_X, PICKER_Y, chromeFilePicker, sizeof(chromeFilePicker) / sizeof(Ui::ChromeBand));
+  }
+  else
   {
-    if (entriesPipeDelimited[index] == 0)
+    m_tft.fillRect(PICKER_X+1, PICKER_Y+1, PICKER_WIDTH-2, PICKER_HEIGHT-2, COLOR_WHITE);
+  }
+  
+  // kept for drawFilePickerSel()
+  m_filePickerEntries = entriesPipeDelimited;
+  m_filePickerFirstPage = curPage == 1;
+  m_filePickerRoot = rootDirectory;
+  m_filePickerShownSel = curSel;
+  
+  // [.] or [..], then the entries, at least one row
+  BYTE count = m_filePickerFirstPage ? 1 : 0;
+  for (const char* at = entriesPipeDelimited; *at; at++)
+  {
+    if (((at == entriesPipeDelimited) || (at[-1] == '|')) && (*at != '|'))
     {
-      entriesPipeDelimited[index] = '|';
+      count++;
     }
   }
+  m_filePickerCount = (count > PICKER_ROWS) ? PICKER_ROWS : (count ? count : 1);
+  
+  for (BYTE item = 1; item <= m_filePickerCount; item++)
+  {
+    drawFilePickerRow(item, curSel == item, false);
+  }
   
   m_filePicking = true;
 }
 
+bool Ui::drawFilePickerSel(BYTE curSel)
+{
+  // moves the highlight on the page drawn last, only the two rows concerned are redrawn
+  // false: not possible, use drawFilePicker()
+  if (!m_filePicking || !m_filePickerEntries || (curSel > m_filePickerCount))
+  {
+    return false;
+  }
+  
+  if (curSel != m_filePickerShownSel)
+  {
+    drawFilePickerRow(m_filePickerShownSel, false, true);
+    drawFilePickerRow(curSel, true, false);
+    m_filePickerShownSel = curSel;
+  }
+  
+  m_filePicking = true;
+  return true;
+}
+
+void Ui::drawFilePickerRow(BYTE item, bool selected, bool clear)
+{
+  // one row of the picker: background if asked, separator, highlight and name
+  if (!item || (item > PICKER_ROWS))
+  {
+    return;
+  }
+  
+  const WORD itemY = PICKER_Y+(item*PICKER_ROW);
+  if (clear && !selected)
+  {
+    m_tft.fillRect(PICKER_X+1, itemY-21, PICKER_WIDTH-2, PICKER_ROW, COLOR_WHITE);
+  }
+  if (item < PICKER_ROWS)
+  {
+    m_tft.drawFastHLine(PICKER_X+1, itemY, PICKER_WIDTH-1, COLOR_SHADOW);  
+  }
+  if (selected)
+  {
+    m_tft.fillRect(PICKER_X+1, itemY-21, PICKER_WIDTH-2, PICKER_ROW, COLOR_BROWN);
+  }
+  setTextColor(selected ? COLOR_WHITE : COLOR_BLACK, selected ? COLOR_BROWN : COLOR_WHITE);
+  
+  setCursor(PICKER_X+7, itemY-7);
+  if ((item == 1) && m_filePickerFirstPage)
+  {
+    UiText text(m_filePickerRoot ? Progmem::uiPickerRootDir : Progmem::uiPickerOneLevelUp);
+    printText(text);
+  }
+  else
+  {
+    // nth of the pipe-delimited entries
+    const char* entry = m_filePickerEntries;
+    for (BYTE skip = item - (m_filePickerFirstPage ? 2 : 1); entry && skip; skip--)
+    {
+      entry = strchr(entry, '|');
+      entry = entry ? entry+1 : NULL;
+    }
+    
+    if (entry)
+    {
+      // drawn up to the delimiter, in place
+      const char* end = strchr(entry, '|');
+      UiText text(entry, end ? (end - entry) : strlen(entry));
+      printText(text);
+    }
+  }
+  
+  setTextColor(COLOR_BLACK, COLOR_BACKGROUND);
+}
+
+void Ui::drawFilePickerDetails(DWORD curPage, DWORD pages, bool clearLine)
+{
+  // page indicator, pages 0: total not known yet
+  char total[11] = "?";
+  if (pages)
+  {
+    ultoa(pages, total, 10);
+  }
+  
+  setCursorY(PICKER_DETAILS_Y);
+  
+  // also updated in the background, the picker stays
+  const bool filePicking = m_filePicking;
+  outText(UiText(Progmem::uiPickerDetails, curPage, total), true, false, clearLine);
+  m_filePicking = filePicking;
+}
+
 Ui::ButtonAction Ui::buttonPressed()
 { 
-  if (!m_buttonRow || !m_buttonsCount)
+  // scene described by now
+  sceneEnd();
+  
+  // touches with nothing to press go
+  if (!m_buttonsCount)
   {
+    m_touch.flushEvents();
+    m_touchDown = false;
     return ButtonAction::NoButton;
   }
 
-  TSPoint pt = m_touch.getPoint();
-  const bool dataAvailable = pt.z > 0; // pressure detected
+  // touches sampled meanwhile, one event per pass; the finger's last position is kept between them
+  TouchEvent event;
+  m_touch.poll();
+  if (!m_touch.getEvent(event))
+  {
+    event.type = Touch::TouchNone;
+  }
+  else
+  {
+    m_touchDown = event.type != Touch::TouchRelease;
+    m_touchX = event.x;
+    m_touchY = event.y;
+  }
+  const DWORD now = event.type ? event.time : millis();
+  const int16_t X = m_touchX;
+  const int16_t Y = m_touchY;
   
-  // ignore finger held on touchscreen:
-  // only works reliably if the touchscreen is active (XPT2046),
-  // or its X/Y pins are not shared together with the TFT data bus 
-  static bool held = false;
+  // file picker list flung: keeps scrolling, slowing down until stopped or touched
+  if (m_scrollStep && (m_touchDown || !m_filePicking))
+  {
+    m_scrollStep = 0;
+  }
+  else if (m_scrollStep && ((now - m_scrollTime) >= m_scrollInterval))
+  {
+    m_scrollTime = now;
+    m_scrollInterval += (m_scrollInterval / 4) + 1;
+    
+    const ButtonAction action = (m_scrollStep > 0) ? ButtonAction::Down : ButtonAction::Up;
+    if (m_scrollInterval > UI_SCROLL_STOP)
+    {
+      m_scrollStep = 0;
+    }
+    return action;
+  }
    
-  if (dataAvailable && !held)
+  if (event.type == Touch::TouchPress)
   { 
-    held = true;
- 
-#ifdef DISP_FLIP_ORIENTATION
-    pt.x = DISP_WIDTH - pt.x;
-    pt.y = DISP_HEIGHT - pt.y;
-#endif 
+    m_dragging = false;
         
-    for (BYTE at = 0; at < m_buttonsCount; at++)
+    // button bar from its table
+    const WORD barY = pgm_read_word(&m_buttonBar->Y);
+    if ((Y >= barY) && (Y <= barY + pgm_read_byte(&m_buttonBar->height)))
     {
-      const ButtonRow* button = &m_buttonRow[at];
+      const BYTE count = pgm_read_byte(&m_buttonBar->count);
+      const BYTE width = pgm_read_byte(&m_buttonBar->width);
+      WORD X1 = pgm_read_word(&m_buttonBar->left[m_buttonsCount-1]);
       
-      if ((pt.x >= button->X1) && (pt.x <= button->X2) && (pt.y >= button->Y1) && (pt.y <= button->Y2))
+      for (BYTE at = 0; at < count; at++)
       {
-        return button->action;
+        if (!(m_buttonsShown & (1 << at)))
+        {
+          continue;
+        }
+        
+        if ((X >= X1) && (X <= X1 + width))
+        {
+          return (ButtonAction)pgm_read_byte(&m_buttonBar->buttons[at].action);
+        }
+        X1 += width + UI_BUTTON_SPACING;
       }
     }
     
     // picked a file
     if (m_filePicking)
     {
-      const BYTE pickerItemHeight = DISP_HEIGHT*0.56 / 6;
-
       for (WORD item = 1; item <= m_filePickerCount; item++)
       {
-        const WORD X1 = (DISP_WIDTH/18)+1;
-        const WORD Y1 = (DISP_HEIGHT/6.25)+(item*pickerItemHeight)-21;
-        const WORD X2 = X1 + (DISP_WIDTH*0.89)-2;
-        const WORD Y2 = Y1 + pickerItemHeight;
+        const WORD X1 = PICKER_X+1;
+        const WORD Y1 = PICKER_Y+(item*PICKER_ROW)-21;
+        const WORD X2 = X1 + PICKER_WIDTH-2;
+        const WORD Y2 = Y1 + PICKER_ROW;
         
-        if ((pt.x >= X1) && (pt.x <= X2) && (pt.y >= Y1) && (pt.y <= Y2))
+        if ((X >= X1) && (X <= X2) && (Y >= Y1) && (Y <= Y2))
         {
+          // may turn into a drag
+          m_dragging = true;
+          m_dragY = Y;
+          m_scrollTime = now;
+          m_scrollInterval = 0;
+          
           m_filePickerSel = item;
           return ButtonAction::FilePicked;
         }
       }
     }
   }
+  
+  // dragged over a row height: one entry further, the finger moving up scrolls down the list
+  else if (m_touchDown && m_dragging && m_filePicking)
+  {
+    const int distance = (int)Y - (int)m_dragY;
+    
+    if ((distance >= PICKER_ROW) || (distance <= -PICKER_ROW))
+    {
+      m_dragY += (distance > 0) ? PICKER_ROW : -PICKER_ROW;
+      m_scrollInterval = now - m_scrollTime;
+      m_scrollTime = now;
+      m_dragDown = distance < 0;
+      return m_dragDown ? ButtonAction::Down : ButtonAction::Up;
+    }
+  }
 
-  if (held && !dataAvailable)
+  if (event.type == Touch::TouchRelease)
   {
-    held = false;
+    // released while still moving fast
+    if (m_dragging && m_scrollInterval && (m_scrollInterval < UI_SCROLL_FLING) && ((now - m_scrollTime) < UI_SCROLL_FLING))
+    {
+      m_scrollStep = m_dragDown ? 1 : -1;
+      m_scrollTime = now;
+    }
+    m_dragging = false;
   }
 
   return ButtonAction::NoButton;  
@@ -5,7 +5,69 @@
 #pragma once
 #include "config.h"
 
-#define BUTTONS_COUNTOF(b) (sizeof((b)) / sizeof(Ui::Button))
+#define UI_MAX_BUTTONS     6 // file picker button bar
+#define UI_SCROLL_FLING    120 // ms, file picker drag released faster than a row per this keeps scrolling
+#define UI_SCROLL_STOP     250 // ms, - || - until slowed down to a row per this
+#ifdef UI_DASHBOARD
+#define UI_SCENE_ITEMS     28  // rectangles tracked on the screen
+#else
+#define UI_SCENE_ITEMS     20
+#endif
+#define UI_SEG_WIDTH       32  // seven segment font cell, px
+#define UI_SEG_HEIGHT      50
+
+// button bar layout, px, integer only so that the tables are laid out by the compiler
+#define UI_BUTTON_SPACING  (DISP_WIDTH/80)
+#define UI_BAR_Y_BOX       ((DISP_HEIGHT*13)/20)  // in a message box
+#define UI_BAR_Y_IDLE      ((DISP_HEIGHT*77)/100)
+#define UI_BAR_Y_PICKER    ((DISP_HEIGHT*41)/50)  // below the file picker
+#define UI_BAR_LEFT(count, width) (WORD)((DISP_WIDTH/2) - ((((width)*(count)) + (UI_BUTTON_SPACING*((count)-1)))/2) - 1)
+#define UI_BAR_LEFTS(width) { UI_BAR_LEFT(1, width), UI_BAR_LEFT(2, width), UI_BAR_LEFT(3, width), \
+                              UI_BAR_LEFT(4, width), UI_BAR_LEFT(5, width), UI_BAR_LEFT(6, width) }
+
+#define UI_TEXT_ARGS       4   // format arguments
+
+// format argument: %u, %lu and %c take the number, %s the RAM string
+struct UiArg
+{
+  union
+  {
+    DWORD number;
+    const char* text;
+  };
+  
+  UiArg() : number(0) {}
+  UiArg(DWORD value) : number(value) {}
+  UiArg(const char* value) : text(value) {}
+};
+
+// text measured, hashed and drawn in place, one character at a time:
+// a RAM string, a PROGMEM string of known length, or a PROGMEM format expanded with its arguments
+class UiText
+{
+public:
+  UiText(const char* text) : UiText(text, text ? strlen(text) : 0) {}
+  UiText(const char* text, WORD length);
+  UiText(BYTE progmemString);
+  UiText(BYTE progmemFormat, UiArg arg0, UiArg arg1 = UiArg(), UiArg arg2 = UiArg(), UiArg arg3 = UiArg());
+  
+  WORD length() const { return m_length; }
+  void rewind();
+  char next();               // 0 past the end
+  
+private:
+  const char* m_text;
+  WORD m_length;
+  WORD m_at;
+  bool m_progmem;
+  bool m_format;
+  
+  // format: arguments, the next to expand, and the one being expanded
+  UiArg m_args[UI_TEXT_ARGS];
+  BYTE m_arg;
+  const char* m_expanding;
+  char m_number[11];
+};
 
 class Ui
 {
@@ -13,23 +75,27 @@ public:
 
   struct Button
   {
-    Button(BYTE a = 0, BYTE c = 0)
-    {
-      action = a;
-      progmemCaption = c;
-    }
-    
     BYTE action;
     BYTE progmemCaption;
   };
   
-  struct ButtonRow
+  // centered row of buttons, in PROGMEM
+  struct ButtonBar
   {
-    BYTE action;
-    WORD X1;
-    WORD Y1;
-    WORD X2;
-    WORD Y2;    
+    WORD Y;
+    BYTE width;              // each
+    BYTE height;
+    BYTE count;
+    Button buttons[UI_MAX_BUTTONS];
+    WORD left[UI_MAX_BUTTONS]; // first button, by the number of buttons shown
+  };
+  
+  // window chrome in PROGMEM, rows alike run-length encoded as up to three spans from the left
+  struct ChromeBand
+  {
+    BYTE rows;
+    WORD length[3];
+    WORD color[3];
   };
   
   enum ButtonAction
@@ -53,18 +119,80 @@ public:
     PgUp,
     PgDn,
     Open,
-    FilePicked    
+    FilePicked,
+    Find,
+    PrevChar,
+    NextChar,
+    AddChar,
+    DelChar
   }; 
 
+  // fixed screens
+  inline static const ButtonBar m_barIdle PROGMEM = 
+  {
+    UI_BAR_Y_IDLE, (DISP_WIDTH*10)/46, (DISP_HEIGHT*2)/15, 4,
+    { {Mount, Progmem::btnMount}, {Unmount, Progmem::btnUnmount}, {Create, Progmem::btnCreate}, {Eject, Progmem::btnEject} },
+    UI_BAR_LEFTS((DISP_WIDTH*10)/46)
+  };
+  
+  inline static const ButtonBar m_barOK PROGMEM = 
+  {
+    UI_BAR_Y_BOX, (DISP_WIDTH*2)/7, (DISP_HEIGHT*2)/15, 1,
+    { {OK, Progmem::btnOK} },
+    UI_BAR_LEFTS((DISP_WIDTH*2)/7)
+  };
+  
+  inline static const ButtonBar m_barBack PROGMEM = 
+  {
+    UI_BAR_Y_BOX, (DISP_WIDTH*2)/7, (DISP_HEIGHT*2)/15, 1,
+    { {Back, Progmem::btnBack} },
+    UI_BAR_LEFTS((DISP_WIDTH*2)/7)
+  };
+  
+  inline static const ButtonBar m_barYesNo PROGMEM = 
+  {
+    UI_BAR_Y_BOX, (DISP_WIDTH*2)/7, (DISP_HEIGHT*2)/15, 2,
+    { {Yes, Progmem::btnYes}, {No, Progmem::btnNo} },
+    UI_BAR_LEFTS((DISP_WIDTH*2)/7)
+  };
+  
+  inline static const ButtonBar m_barYesNoCancel PROGMEM = 
+  {
+    UI_BAR_Y_BOX, DISP_WIDTH/4, (DISP_HEIGHT*2)/15, 3,
+    { {Yes, Progmem::btnYes}, {No, Progmem::btnNo}, {Cancel, Progmem::btnCancel} },
+    UI_BAR_LEFTS(DISP_WIDTH/4)
+  };
+  
+  inline static const ButtonBar m_barDrives PROGMEM = 
+  {
+    UI_BAR_Y_BOX, DISP_WIDTH/7, (DISP_HEIGHT*2)/15, 6,
+    { {DriveA, Progmem::btnDriveA}, {DriveB, Progmem::btnDriveB}, {DriveC, Progmem::btnDriveC}, {DriveD, Progmem::btnDriveD},
+      {Find, Progmem::btnFind}, {Back, Progmem::btnBack} },
+    UI_BAR_LEFTS(DISP_WIDTH/7)
+  };
+  
+  inline static const ButtonBar m_barFilePicker PROGMEM = 
+  {
+    UI_BAR_Y_PICKER, DISP_WIDTH/8, DISP_HEIGHT/10, 6,
+    { {PgUp, Progmem::btnPgUp}, {PgDn, Progmem::btnPgDn}, {Up, Progmem::btnUp}, {Down, Progmem::btnDown}, 
+      {Open, Progmem::btnOpen}, {Back, Progmem::btnBack} },
+    UI_BAR_LEFTS(DISP_WIDTH/8)
+  };
+  
+  inline static const ButtonBar m_barFindPrompt PROGMEM = 
+  {
+    UI_BAR_Y_PICKER, DISP_WIDTH/8, DISP_HEIGHT/10, 6,
+    { {PrevChar, Progmem::btnPrevChar}, {NextChar, Progmem::btnNextChar}, {AddChar, Progmem::btnAddChar}, {DelChar, Progmem::btnDelChar},
+      {Find, Progmem::btnFind}, {Back, Progmem::btnBack} },
+    UI_BAR_LEFTS(DISP_WIDTH/8)
+  };
+
   static Ui* get()
   {
     static Ui ui;
     return &ui;
   }
   
-  //leave more for variadic expansion
-  inline static char m_stringBuffer[MAX_PROGMEM_STRING_LEN + 24] = {0};
-  
   WORD getCursorX() { return m_tft.getCursorX(); }
   WORD getCursorY() { return m_tft.getCursorY(); }
   void setCursorX(WORD X) { m_tft.setCursor(X, m_tft.getCursorY()); }
@@ -72,13 +200,26 @@ public:
   void setCursor(WORD X, WORD Y) { m_tft.setCursor(X, Y); }
   
   void clearScreen();
-  void outText(const char* text, bool centerHorz = false, bool centerVert = false, bool clearLine = false);
-  void outButtons(const Button* buttons, const BYTE count, WORD widthEach, WORD heightEach);
+  void outText(UiText text, bool centerHorz = false, bool centerVert = false, bool clearLine = false);
+  void outButtons(const ButtonBar* bar, BYTE shown = 0xFF); // bar in PROGMEM, shown: bitmask of its buttons
   ButtonAction buttonPressed();
-  void messageBox(BYTE progmemContent, BYTE progmemCaption = 0, bool hasButtons = true);
-  void messageBox(const char* content, const char* caption = NULL, bool hasButtons = true);
+  void messageBox(UiText content, UiText caption = Progmem::Empty, bool hasButtons = true);
+  
+  // dashboard
+  enum Indicator
+  {
+    IndicatorOff = 0,        // drive not mounted
+    IndicatorIdle,
+    IndicatorRead,
+    IndicatorWrite
+  };
+  void outIndicator(BYTE indicator);    // box at the cursor
+  void outSevenSeg(const char* text);   // big digits at the cursor, baseline at the bottom of the cells
   
   void drawFilePicker(bool rootDirectory, char* entriesPipeDelimited, BYTE curSel, DWORD curPage, DWORD pages);
+  bool drawFilePickerSel(BYTE curSel);
+  void drawFilePickerDetails(DWORD curPage, DWORD pages, bool clearLine = true);
+  bool isFilePicking() { return m_filePicking; }
   BYTE getFilePickerCount() { return m_filePickerCount; }
   BYTE getFilePickerSel() { return m_filePickerSel; }
   
@@ -88,10 +229,69 @@ private:
   MCUFRIEND_kbv m_tft;
   Touch m_touch;
   
-  ButtonRow* m_buttonRow;
+  const ButtonBar* m_buttonBar; // PROGMEM
+  BYTE m_buttonsShown;
   BYTE m_buttonsCount;
   
+  enum SceneState
+  {
+    SceneFree = 0,
+    SceneLive,               // described in the current scene
+    SceneStale               // shown, not described again yet
+  };
+  
+  struct SceneItem
+  {
+    WORD X;
+    WORD Y;
+    WORD W;
+    WORD H;
+    WORD hash;               // of what is shown
+    WORD under;              // color to erase with
+    BYTE state;
+  };
+  
+  void sceneBegin();
+  void sceneEnd();
+  void sceneErase(BYTE index, bool fill);
+  static bool sceneContains(const SceneItem& outer, WORD X, WORD Y, WORD W, WORD H);
+  bool sceneItem(WORD X, WORD Y, WORD W, WORD H, WORD hash, WORD under);
+  WORD sceneHash(UiText text, WORD color, WORD hash = 0xFFFF);
+  void drawTitleBar(WORD color);
+  void drawMessageBox();
+  void drawChrome(WORD X, WORD Y, const ChromeBand* bands, BYTE count, WORD fill = 0);
+  void drawButton(WORD X, WORD Y, BYTE width, BYTE height, WORD face);
+  void setTextColor(WORD color, WORD background);
+  void printText(UiText& text);
+  void drawFilePickerRow(BYTE item, bool selected, bool clear);
+  
   bool m_filePicking;
   BYTE m_filePickerCount;
   BYTE m_filePickerSel;
+  
+  // page drawn last, entries not owned
+  const char* m_filePickerEntries;
+  bool m_filePickerFirstPage;
+  bool m_filePickerRoot;
+  BYTE m_filePickerShownSel;
+  
+  SceneItem m_scene[UI_SCENE_ITEMS];
+  bool m_sceneOpen;          // erasing leftovers of the previous scene pending
+  bool m_sceneLost;          // more shown than tracked
+  
+  WORD m_textColor;
+  WORD m_textBackground;
+  
+  // file picker drag and fling
+  bool m_dragging;
+  bool m_dragDown;
+  WORD m_dragY;
+  char m_scrollStep;        // flung: 1 down, -1 up, 0 not scrolling
+  DWORD m_scrollTime;       // last row scrolled
+  WORD m_scrollInterval;
+  
+  // touch events consumed so far: the finger down and where it was last seen
+  bool m_touchDown;
+  int16_t m_touchX;
+  int16_t m_touchY;
 };
\ No newline at end of file